@@ -0,0 +1,67 @@
+// Throughput of the Whisper context pool: jobs/sec with 1..N contexts sharing one model
+#include "whisper_pool.hpp"
+#include "audio_file.hpp"
+#include "settings.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace SuperWhisper;
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: %s MODEL AUDIO.wav [max_contexts=4] [jobs=8] [threads=hw]\n", argv[0]);
+        return 1;
+    }
+
+    const std::string model_path = argv[1];
+    const int max_contexts = argc > 3 ? std::atoi(argv[3]) : 4;
+    const int jobs = argc > 4 ? std::atoi(argv[4]) : 8;
+    const int threads = argc > 5 ? std::atoi(argv[5]) : static_cast<int>(std::thread::hardware_concurrency());
+
+    AudioFile audio;
+    std::string error;
+    if (!read_audio_file(argv[2], audio, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    const double audio_seconds = static_cast<double>(audio.samples.size()) / audio.sample_rate;
+
+    Settings settings;
+    settings.language = "en";
+    settings.num_threads = threads;
+    settings.print_progress = false;
+
+    std::printf("%d jobs of %.1fs audio, %d threads total\n", jobs, audio_seconds, threads);
+    std::printf("%9s %10s %10s %9s %10s\n", "contexts", "wall (s)", "jobs/s", "speedup", "audio x RT");
+
+    double baseline = 0.0;
+    for (int contexts = 1; contexts <= max_contexts; ++contexts) {
+        auto pool = create_whisper_pool(contexts);
+        if (!pool->load_model(model_path)) {
+            return 1;
+        }
+
+        // Warm-up: first decode per context pays one-off allocation and (on Metal) pipeline setup
+        std::vector<std::future<TranscriptSegments>> warmup;
+        for (int i = 0; i < contexts; ++i) warmup.push_back(pool->submit(audio.samples, audio.sample_rate, settings));
+        for (auto& job : warmup) job.get();
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::future<TranscriptSegments>> results;
+        for (int i = 0; i < jobs; ++i) results.push_back(pool->submit(audio.samples, audio.sample_rate, settings));
+        for (auto& job : results) job.get();
+        const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const double jobs_per_second = jobs / wall;
+        if (contexts == 1) baseline = jobs_per_second;
+        std::printf("%9d %10.2f %10.2f %8.2fx %10.1f\n", contexts, wall, jobs_per_second,
+                    jobs_per_second / baseline, jobs * audio_seconds / wall);
+    }
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+// Stop-to-text latency: audio is fed in real time (20 ms callbacks), then the time from
+// "stop" to the final transcript is measured for the three transcription paths:
+//   stop         - nothing happens while recording, everything is decoded after stop (default CLI)
+//   windowed     - streaming_mode, overlapping windows committed by local agreement
+//   speculative  - speculative_decode, speech decoded in the background at every pause
+#include "streaming_transcriber.hpp"
+#include "whisper_wrapper.hpp"
+#include "audio_file.hpp"
+#include "settings.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace SuperWhisper;
+
+namespace {
+
+constexpr int kSampleRate = 16000;
+constexpr size_t kChunkSamples = kSampleRate / 50;  // 20 ms, a typical capture callback
+
+struct RunResult {
+    double stop_to_text_ms = 0.0;
+    size_t text_bytes = 0;
+};
+
+// Feed `audio` at `speed` x real time; `on_chunk` sees every callback's worth of samples
+template <typename OnChunk>
+void feed(const AudioBuffer& audio, double speed, OnChunk on_chunk) {
+    const auto chunk_time = std::chrono::duration<double>(static_cast<double>(kChunkSamples) / kSampleRate / speed);
+    auto next = std::chrono::steady_clock::now();
+    for (size_t pos = 0; pos < audio.size(); pos += kChunkSamples) {
+        on_chunk(audio.data() + pos, std::min(kChunkSamples, audio.size() - pos));
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(chunk_time);
+        std::this_thread::sleep_until(next);
+    }
+}
+
+size_t text_bytes(const TranscriptSegments& segments) {
+    size_t bytes = 0;
+    for (const auto& segment : segments) bytes += segment.text.size();
+    return bytes;
+}
+
+RunResult run_stop(WhisperWrapper& whisper, const AudioBuffer& audio, double speed, const Settings& settings) {
+    AudioBuffer captured;
+    captured.reserve(audio.size());
+    feed(audio, speed, [&](const AudioSample* data, size_t count) { captured.insert(captured.end(), data, data + count); });
+
+    const auto stop = std::chrono::steady_clock::now();
+    const TranscriptSegments segments = whisper.transcribe_segments(captured, kSampleRate, settings);
+    const auto done = std::chrono::steady_clock::now();
+    return {std::chrono::duration<double, std::milli>(done - stop).count(), text_bytes(segments)};
+}
+
+RunResult run_background(WhisperWrapper& whisper, const AudioBuffer& audio, double speed, const Settings& settings) {
+    auto transcriber = create_streaming_transcriber(whisper, settings);
+    transcriber->start();
+    feed(audio, speed, [&](const AudioSample* data, size_t count) { transcriber->push_audio(data, count); });
+
+    const auto stop = std::chrono::steady_clock::now();
+    const TranscriptSegments segments = transcriber->finish();
+    const auto done = std::chrono::steady_clock::now();
+    return {std::chrono::duration<double, std::milli>(done - stop).count(), text_bytes(segments)};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: %s MODEL AUDIO.wav [runs=3] [speed=1.0] [tail_ms=0] [threads=4]\n", argv[0]);
+        std::fprintf(stderr, "  tail_ms: silence appended before stop (the CLI auto-stops after silence_duration)\n");
+        return 1;
+    }
+
+    const std::string model_path = argv[1];
+    const int runs = argc > 3 ? std::max(1, std::atoi(argv[3])) : 3;
+    const double speed = argc > 4 ? std::max(0.1, std::atof(argv[4])) : 1.0;
+    const int tail_ms = argc > 5 ? std::max(0, std::atoi(argv[5])) : 0;
+    const int threads = argc > 6 ? std::atoi(argv[6]) : 4;
+
+    AudioFile file;
+    std::string error;
+    if (!read_audio_file(argv[2], file, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    resample_audio_file(file, kSampleRate);
+
+    AudioBuffer audio = std::move(file.samples);
+    audio.resize(audio.size() + static_cast<size_t>(tail_ms) * kSampleRate / 1000, 0);
+    const double audio_seconds = static_cast<double>(audio.size()) / kSampleRate;
+
+    auto whisper = create_whisper_wrapper();
+    if (!whisper->load_model(model_path)) {
+        return 1;
+    }
+
+    Settings settings;
+    settings.language = "en";
+    settings.num_threads = threads;
+    settings.print_progress = false;
+    settings.sample_rate = kSampleRate;
+    settings.max_duration = static_cast<int>(audio_seconds) + 2;
+    whisper->reserve(audio.size(), kSampleRate);
+
+    Settings windowed = settings;
+    windowed.streaming_mode = true;
+    Settings speculative = settings;
+    speculative.speculative_decode = true;
+
+    // Warm-up: the first decode pays one-off allocation and (on Metal) pipeline setup
+    whisper->transcribe_segments(audio, kSampleRate, settings);
+
+    std::printf("%.1fs of audio fed at %.1fx real time (%d ms trailing silence), %d run(s), %d threads\n",
+                audio_seconds, speed, tail_ms, runs, threads);
+    std::printf("%-12s %14s %14s %10s\n", "path", "stop->text p50", "stop->text max", "text (B)");
+
+    const struct {
+        const char* name;
+        const Settings* settings;
+        bool background;
+    } paths[] = {{"stop", &settings, false}, {"windowed", &windowed, true}, {"speculative", &speculative, true}};
+
+    for (const auto& path : paths) {
+        std::vector<double> latencies;
+        size_t bytes = 0;
+        for (int run = 0; run < runs; ++run) {
+            const RunResult result = path.background ? run_background(*whisper, audio, speed, *path.settings)
+                                                     : run_stop(*whisper, audio, speed, *path.settings);
+            latencies.push_back(result.stop_to_text_ms);
+            bytes = result.text_bytes;
+        }
+        std::sort(latencies.begin(), latencies.end());
+        std::printf("%-12s %11.1f ms %11.1f ms %10zu\n", path.name, latencies[latencies.size() / 2], latencies.back(), bytes);
+    }
+
+    return 0;
+}
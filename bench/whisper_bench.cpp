@@ -0,0 +1,365 @@
+// End-to-end benchmark: model load, transcription latency percentiles, RTF and
+// peak RSS over a fixed corpus of utterance lengths, plus capture-path micro-benchmarks.
+// Heap allocations per call are counted too, to check the hot paths reuse their buffers.
+#include "whisper_wrapper.hpp"
+#include "audio_file.hpp"
+#include "audio_dsp.hpp"
+#include "resampler.hpp"
+#include "ring_buffer.hpp"
+#include "settings.hpp"
+#include "system_info.hpp"
+#include "vad.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using namespace SuperWhisper;
+using json = nlohmann::json;
+
+// Every operator new in the process (ours, whisper.cpp's C++ containers, the
+// standard library). ggml's tensor memory comes from malloc and is not counted.
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+constexpr int kWhisperRate = 16000;
+
+// Keeps results observable so the optimizer cannot drop the kernel calls
+volatile float g_sink = 0.0f;
+
+struct Options {
+    std::vector<std::string> models;
+    std::string audio_path = "external/whisper.cpp/samples/jfk.wav";
+    std::vector<int> lengths = {2, 5, 10, 30};
+    std::vector<int> threads = {4};
+    std::vector<bool> gpu = {true};
+    std::vector<std::string> presets = {"custom"};  // decode_preset values; custom = Settings defaults
+    int runs = 5;
+    std::string json_path;
+    bool capture_only = false;
+    bool use_mmap = true;
+};
+
+std::vector<std::string> parse_names(const char* text) {
+    std::vector<std::string> names;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) names.push_back(item);
+    }
+    return names;
+}
+
+std::vector<int> parse_list(const char* text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) values.push_back(std::atoi(item.c_str()));
+    }
+    return values;
+}
+
+double milliseconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Nearest-rank percentile of an unsorted sample
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * values.size()));
+    return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+}
+
+double mean(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    return values.empty() ? 0.0 : sum / values.size();
+}
+
+// Voiced, amplitude-modulated tone over noise - enough to exercise VAD and DSP
+AudioBuffer synthetic_signal(int seconds) {
+    AudioBuffer synthetic(static_cast<size_t>(seconds) * kWhisperRate);
+    std::mt19937 rng(42);
+    std::normal_distribution<float> noise(0.0f, 1500.0f);
+    for (size_t i = 0; i < synthetic.size(); ++i) {
+        const float envelope = 0.5f + 0.5f * std::sin(2.0f * 3.14159265f * 3.0f * i / kWhisperRate);
+        synthetic[i] = static_cast<AudioSample>(envelope * 6000.0f * std::sin(2.0f * 3.14159265f * 180.0f * i / kWhisperRate) + noise(rng));
+    }
+    return synthetic;
+}
+
+// Source speech at 16 kHz; falls back to the synthetic signal when no file is available
+AudioBuffer load_source(const std::string& path) {
+    AudioFile audio;
+    std::string error;
+    if (read_audio_file(path, audio, error) && !audio.samples.empty()) {
+        resample_audio_file(audio, kWhisperRate);
+        return audio.samples;
+    }
+
+    std::cerr << "Warning: " << error << " - using a synthetic signal (decode times will not be representative)" << std::endl;
+    return synthetic_signal(10);
+}
+
+// The first `seconds` of the source, repeated as needed
+AudioBuffer make_utterance(const AudioBuffer& source, int seconds) {
+    AudioBuffer utterance(static_cast<size_t>(seconds) * kWhisperRate);
+    for (size_t i = 0; i < utterance.size(); ++i) {
+        utterance[i] = source[i % source.size()];
+    }
+    return utterance;
+}
+
+struct CallCost {
+    double ns = 0.0;
+    double allocations = 0.0;
+};
+
+// Nanoseconds and heap allocations per call of `fn` over `iterations` calls (after a warm-up)
+CallCost cost_per_call(int iterations, const std::function<void()>& fn) {
+    for (int i = 0; i < iterations / 10 + 1; ++i) fn();
+    const size_t allocations = g_allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn();
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return {ns / iterations, static_cast<double>(g_allocations.load() - allocations) / iterations};
+}
+
+// Capture-side work done per audio callback: ring write (add_audio_chunk),
+// live VAD, int16 -> float conversion and native-rate resampling
+json benchmark_capture() {
+    constexpr size_t kChunk = 512;  // 32 ms at 16 kHz, the default callback size
+    const double budget_ns = kChunk * 1e9 / kWhisperRate;
+    const int iterations = 20000;
+
+    const AudioBuffer source = synthetic_signal(1);
+    AudioBuffer chunk(source.begin(), source.begin() + kChunk);
+    AudioBuffer native_chunk(kChunk * 3);  // Same 32 ms at 48 kHz
+    for (size_t i = 0; i < native_chunk.size(); ++i) native_chunk[i] = source[i % source.size()];
+
+    SpscRingBuffer<AudioSample> ring(static_cast<size_t>(kWhisperRate) * 30);
+    Settings settings;
+    settings.vad_mode = "energy";
+    auto energy_vad = create_vad(settings);
+    settings.vad_mode = "peak";
+    auto peak_vad = create_vad(settings);
+    std::vector<float> floats(native_chunk.size());
+    std::vector<float> resampled(kChunk * 2);
+    PolyphaseResampler resampler(48000, kWhisperRate);
+
+    struct Case {
+        const char* name;
+        std::function<void()> fn;
+    };
+    const std::vector<Case> cases = {
+        {"add_audio_chunk", [&]() { ring.write(chunk.data(), chunk.size()); }},
+        {"vad_energy", [&]() { g_sink = energy_vad->process(chunk.data(), chunk.size()); }},
+        {"vad_peak", [&]() { g_sink = peak_vad->process(chunk.data(), chunk.size()); }},
+        {"int16_to_float", [&]() { dsp::int16_to_float(chunk.data(), floats.data(), chunk.size()); g_sink = floats[7]; }},
+        {"resample_48k_16k", [&]() {
+            dsp::int16_to_float(native_chunk.data(), floats.data(), native_chunk.size());
+            g_sink = static_cast<float>(resampler.process(floats.data(), native_chunk.size(), resampled.data()));
+        }},
+    };
+
+    std::printf("\nCapture path (per %zu-sample / 32 ms callback, %s kernels)\n", kChunk, dsp::kernel_name());
+    std::printf("%-18s %12s %10s %8s\n", "stage", "ns/chunk", "% budget", "allocs");
+
+    json results = json::array();
+    for (const auto& c : cases) {
+        const CallCost cost = cost_per_call(iterations, c.fn);
+        std::printf("%-18s %12.1f %9.4f%% %8.2f\n", c.name, cost.ns, 100.0 * cost.ns / budget_ns, cost.allocations);
+        results.push_back({{"stage", c.name}, {"ns_per_chunk", cost.ns}, {"budget_percent", 100.0 * cost.ns / budget_ns},
+                           {"allocations_per_chunk", cost.allocations}});
+    }
+
+    return json{{"chunk_samples", kChunk}, {"dsp_kernel", dsp::kernel_name()}, {"stages", results}};
+}
+
+// Load each model once per GPU setting, then sweep thread counts and utterance lengths
+json benchmark_models(const Options& options) {
+    const AudioBuffer source = load_source(options.audio_path);
+    json results = json::array();
+
+    for (const auto& model_path : options.models) {
+        for (bool use_gpu : options.gpu) {
+            auto wrapper = create_whisper_wrapper();
+            ModelLoadOptions load;
+            load.use_gpu = use_gpu;
+            load.use_mmap = options.use_mmap;
+
+            const auto load_start = std::chrono::steady_clock::now();
+            if (!wrapper->load_model(model_path, load)) {
+                std::cerr << "Skipping " << model_path << std::endl;
+                continue;
+            }
+            const double load_ms = milliseconds_since(load_start);
+            const size_t loaded_rss = current_rss_bytes();
+
+            std::printf("\n%s (gpu %s): load %.0f ms, RSS %.0f MB\n", model_path.c_str(), use_gpu ? "on" : "off",
+                        load_ms, loaded_rss / (1024.0 * 1024.0));
+            std::printf("%-12s %7s %7s %9s %9s %9s %9s %9s %7s %8s\n", "preset", "threads", "length", "p50 ms", "p95 ms",
+                        "p99 ms", "encode", "decode", "RTF", "allocs");
+
+            json config = {{"model", model_path}, {"gpu", use_gpu}, {"mmap", options.use_mmap}, {"load_ms", load_ms},
+                           {"loaded_rss_bytes", loaded_rss}, {"runs", json::array()}};
+
+            // Buffers for the longest utterance up front, as the CLI does for max_duration
+            int longest = 0;
+            for (int seconds : options.lengths) longest = std::max(longest, seconds);
+            wrapper->reserve(static_cast<size_t>(longest) * kWhisperRate, kWhisperRate);
+
+            for (const auto& preset : options.presets) {
+                for (int threads : options.threads) {
+                    Settings settings;
+                    settings.num_threads = threads;
+                    settings.print_progress = false;
+                    settings.decode_preset = preset;
+                    apply_decode_preset(settings, true);
+
+                    for (int seconds : options.lengths) {
+                        const AudioBuffer utterance = make_utterance(source, seconds);
+                        std::vector<double> latency, encode, decode;
+                        size_t allocations = 0;
+
+                        wrapper->transcribe(utterance, kWhisperRate, settings);  // Warm-up (first-run allocations, GPU pipelines)
+                        for (int run = 0; run < options.runs; ++run) {
+                            const size_t allocations_before = g_allocations.load();
+                            const auto start = std::chrono::steady_clock::now();
+                            wrapper->transcribe(utterance, kWhisperRate, settings);
+                            latency.push_back(milliseconds_since(start));
+                            allocations += g_allocations.load() - allocations_before;
+
+                            const DecodeTimings timings = wrapper->last_timings();
+                            encode.push_back(timings.encode_ms);
+                            decode.push_back(timings.decode_ms);
+                        }
+
+                        const double p50 = percentile(latency, 50);
+                        const double rtf = p50 / (seconds * 1000.0);
+                        const double allocations_per_run = static_cast<double>(allocations) / options.runs;
+                        std::printf("%-12s %7d %6ds %9.1f %9.1f %9.1f %9.1f %9.1f %7.3f %8.1f\n", preset.c_str(), threads, seconds, p50,
+                                    percentile(latency, 95), percentile(latency, 99), mean(encode), mean(decode), rtf,
+                                    allocations_per_run);
+
+                        config["runs"].push_back({{"preset", preset},
+                                                  {"threads", threads},
+                                                  {"audio_seconds", seconds},
+                                                  {"p50_ms", p50},
+                                                  {"p95_ms", percentile(latency, 95)},
+                                                  {"p99_ms", percentile(latency, 99)},
+                                                  {"mean_ms", mean(latency)},
+                                                  {"encode_ms", mean(encode)},
+                                                  {"decode_ms", mean(decode)},
+                                                  {"rtf", rtf},
+                                                  {"allocations", allocations_per_run}});
+                    }
+                }
+            }
+
+            config["peak_rss_bytes"] = peak_rss_bytes();
+            results.push_back(config);
+        }
+    }
+
+    return results;
+}
+
+void print_usage(const char* program) {
+    std::printf("Usage: %s [options]\n\n", program);
+    std::printf("  --model PATH       Model to benchmark (repeat for several, default model/ggml-base.en-q5_1.bin)\n");
+    std::printf("  --audio FILE       Speech the corpus is cut from (default external/whisper.cpp/samples/jfk.wav)\n");
+    std::printf("  --lengths LIST     Utterance lengths in seconds (default 2,5,10,30)\n");
+    std::printf("  --threads LIST     Thread counts to sweep (default 4)\n");
+    std::printf("  --gpu on|off|both  GPU backend setting (default on)\n");
+    std::printf("  --presets LIST     decode_preset values to compare, e.g. interactive,accurate (default custom)\n");
+    std::printf("  --runs N           Timed runs per length, after one warm-up (default 5)\n");
+    std::printf("  --json FILE        Write results as JSON ('-' for stdout)\n");
+    std::printf("  --capture-only     Only run the capture-path micro-benchmarks\n");
+    std::printf("  --no-mmap          Load models with whisper.cpp's file reader instead of a mapping\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--model") == 0 && has_value) {
+            options.models.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--audio") == 0 && has_value) {
+            options.audio_path = argv[++i];
+        } else if (strcmp(argv[i], "--lengths") == 0 && has_value) {
+            options.lengths = parse_list(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && has_value) {
+            options.threads = parse_list(argv[++i]);
+        } else if (strcmp(argv[i], "--gpu") == 0 && has_value) {
+            const std::string mode = argv[++i];
+            options.gpu = mode == "both" ? std::vector<bool>{true, false} : std::vector<bool>{mode != "off"};
+        } else if (strcmp(argv[i], "--presets") == 0 && has_value) {
+            options.presets = parse_names(argv[++i]);
+        } else if (strcmp(argv[i], "--runs") == 0 && has_value) {
+            options.runs = std::max(1, std::atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--json") == 0 && has_value) {
+            options.json_path = argv[++i];
+        } else if (strcmp(argv[i], "--capture-only") == 0) {
+            options.capture_only = true;
+        } else if (strcmp(argv[i], "--no-mmap") == 0) {
+            options.use_mmap = false;
+        } else {
+            print_usage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (options.models.empty()) {
+        options.models.push_back("model/ggml-base.en-q5_1.bin");
+    }
+
+    json report;
+    report["capture"] = benchmark_capture();
+    if (!options.capture_only) {
+        report["models"] = benchmark_models(options);
+    }
+    report["peak_rss_bytes"] = peak_rss_bytes();
+
+    if (options.json_path == "-") {
+        std::cout << report.dump(2) << std::endl;
+    } else if (!options.json_path.empty()) {
+        std::ofstream file(options.json_path);
+        if (!file.is_open()) {
+            std::cerr << "Cannot write " << options.json_path << std::endl;
+            return 1;
+        }
+        file << report.dump(2) << std::endl;
+        std::printf("\nResults written to %s\n", options.json_path.c_str());
+    }
+
+    return 0;
+}
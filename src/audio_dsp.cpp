@@ -0,0 +1,312 @@
+#include "audio_dsp.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SUPERWHISPER_DSP_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SUPERWHISPER_DSP_X86 1
+#endif
+
+namespace SuperWhisper {
+namespace dsp {
+
+namespace {
+constexpr float kScale = 1.0f / 32768.0f;
+}
+
+// ---------------------------------------------------------------------------
+// Scalar reference kernels
+
+namespace scalar {
+
+void int16_to_float(const AudioSample* input, float* output, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        output[i] = static_cast<float>(input[i]) * kScale;
+    }
+}
+
+float peak(const AudioSample* input, size_t count) {
+    int max_abs = 0;
+    for (size_t i = 0; i < count; ++i) {
+        max_abs = std::max(max_abs, std::abs(static_cast<int>(input[i])));
+    }
+    return max_abs * kScale;
+}
+
+float energy(const AudioSample* input, size_t count) {
+    if (count == 0) return 0.0f;
+
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        const double sample = input[i];
+        sum += sample * sample;
+    }
+    return static_cast<float>(sum / count) * kScale * kScale;
+}
+
+} // namespace scalar
+
+// ---------------------------------------------------------------------------
+// NEON kernels (Apple Silicon / aarch64 - always available, selected at compile time)
+
+#if SUPERWHISPER_DSP_NEON
+
+namespace neon {
+
+void int16_to_float(const AudioSample* input, float* output, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t x = vld1q_s16(input + i);
+        // Fixed-point convert with 15 fractional bits == divide by 32768
+        vst1q_f32(output + i, vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(x)), 15));
+        vst1q_f32(output + i + 4, vcvtq_n_f32_s32(vmovl_s16(vget_high_s16(x)), 15));
+    }
+    scalar::int16_to_float(input + i, output + i, count - i);
+}
+
+float peak(const AudioSample* input, size_t count) {
+    int16x8_t vmax = vdupq_n_s16(0);
+    int16x8_t vmin = vdupq_n_s16(0);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t x = vld1q_s16(input + i);
+        vmax = vmaxq_s16(vmax, x);
+        vmin = vminq_s16(vmin, x);
+    }
+    // Widen before negating so -32768 is handled exactly
+    int max_abs = std::max<int>(vmaxvq_s16(vmax), -static_cast<int>(vminvq_s16(vmin)));
+    for (; i < count; ++i) {
+        max_abs = std::max(max_abs, std::abs(static_cast<int>(input[i])));
+    }
+    return max_abs * kScale;
+}
+
+float energy(const AudioSample* input, size_t count) {
+    if (count == 0) return 0.0f;
+
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t x = vld1q_s16(input + i);
+        const float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(x)));
+        const float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(x)));
+        acc0 = vfmaq_f32(acc0, lo, lo);
+        acc1 = vfmaq_f32(acc1, hi, hi);
+    }
+    double sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+    for (; i < count; ++i) {
+        const double sample = input[i];
+        sum += sample * sample;
+    }
+    return static_cast<float>(sum / count) * kScale * kScale;
+}
+
+} // namespace neon
+
+#endif
+
+// ---------------------------------------------------------------------------
+// x86 kernels (SSE2 is baseline on x86_64, AVX2 is detected at runtime)
+
+#if SUPERWHISPER_DSP_X86
+
+namespace sse2 {
+
+void int16_to_float(const AudioSample* input, float* output, size_t count) {
+    const __m128 scale = _mm_set1_ps(kScale);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        // Sign-extend by unpacking into the high half and shifting back down
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    scalar::int16_to_float(input + i, output + i, count - i);
+}
+
+static int horizontal_max_epi16(__m128i v) {
+    v = _mm_max_epi16(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_max_epi16(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    v = _mm_max_epi16(v, _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return static_cast<int16_t>(_mm_extract_epi16(v, 0));
+}
+
+static int horizontal_min_epi16(__m128i v) {
+    v = _mm_min_epi16(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_min_epi16(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    v = _mm_min_epi16(v, _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return static_cast<int16_t>(_mm_extract_epi16(v, 0));
+}
+
+float peak(const AudioSample* input, size_t count) {
+    __m128i vmax = _mm_setzero_si128();
+    __m128i vmin = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        vmax = _mm_max_epi16(vmax, x);
+        vmin = _mm_min_epi16(vmin, x);
+    }
+    int max_abs = std::max(horizontal_max_epi16(vmax), -horizontal_min_epi16(vmin));
+    for (; i < count; ++i) {
+        max_abs = std::max(max_abs, std::abs(static_cast<int>(input[i])));
+    }
+    return max_abs * kScale;
+}
+
+float energy(const AudioSample* input, size_t count) {
+    if (count == 0) return 0.0f;
+
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        const __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+        const __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(lo, lo));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(hi, hi));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+    double sum = static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    for (; i < count; ++i) {
+        const double sample = input[i];
+        sum += sample * sample;
+    }
+    return static_cast<float>(sum / count) * kScale * kScale;
+}
+
+} // namespace sse2
+
+namespace avx2 {
+
+__attribute__((target("avx2")))
+void int16_to_float(const AudioSample* input, float* output, size_t count) {
+    const __m256 scale = _mm256_set1_ps(kScale);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i + 8));
+        _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a)), scale));
+        _mm256_storeu_ps(output + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b)), scale));
+    }
+    // Finish the tail here - jumping into non-VEX SSE code with dirty upper
+    // registers would cost an AVX/SSE transition penalty on every call
+    for (; i < count; ++i) {
+        output[i] = static_cast<float>(input[i]) * kScale;
+    }
+}
+
+__attribute__((target("avx2")))
+float peak(const AudioSample* input, size_t count) {
+    __m256i vmax = _mm256_setzero_si256();
+    __m256i vmin = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+        vmax = _mm256_max_epi16(vmax, x);
+        vmin = _mm256_min_epi16(vmin, x);
+    }
+    const __m128i max128 = _mm_max_epi16(_mm256_castsi256_si128(vmax), _mm256_extracti128_si256(vmax, 1));
+    const __m128i min128 = _mm_min_epi16(_mm256_castsi256_si128(vmin), _mm256_extracti128_si256(vmin, 1));
+    int max_abs = std::max(sse2::horizontal_max_epi16(max128), -sse2::horizontal_min_epi16(min128));
+    for (; i < count; ++i) {
+        max_abs = std::max(max_abs, std::abs(static_cast<int>(input[i])));
+    }
+    return max_abs * kScale;
+}
+
+__attribute__((target("avx2,fma")))
+float energy(const AudioSample* input, size_t count) {
+    if (count == 0) return 0.0f;
+
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i + 8));
+        const __m256 fa = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a));
+        const __m256 fb = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b));
+        acc0 = _mm256_fmadd_ps(fa, fa, acc0);
+        acc1 = _mm256_fmadd_ps(fb, fb, acc1);
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, _mm256_add_ps(acc0, acc1));
+    double sum = 0.0;
+    for (float lane : lanes) sum += lane;
+    for (; i < count; ++i) {
+        const double sample = input[i];
+        sum += sample * sample;
+    }
+    return static_cast<float>(sum / count) * kScale * kScale;
+}
+
+} // namespace avx2
+
+#endif
+
+// ---------------------------------------------------------------------------
+// Runtime dispatch
+
+namespace {
+
+struct Kernels {
+    void (*int16_to_float)(const AudioSample*, float*, size_t);
+    float (*peak)(const AudioSample*, size_t);
+    float (*energy)(const AudioSample*, size_t);
+    const char* name;
+};
+
+Kernels select_kernels() {
+#if SUPERWHISPER_DSP_NEON
+    return {neon::int16_to_float, neon::peak, neon::energy, "neon"};
+#elif SUPERWHISPER_DSP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return {avx2::int16_to_float, avx2::peak, avx2::energy, "avx2"};
+    }
+    return {sse2::int16_to_float, sse2::peak, sse2::energy, "sse2"};
+#else
+    return {scalar::int16_to_float, scalar::peak, scalar::energy, "scalar"};
+#endif
+}
+
+// Resolved once; function-local static initialization is thread-safe
+const Kernels& kernels() {
+    static const Kernels selected = select_kernels();
+    return selected;
+}
+
+} // namespace
+
+void int16_to_float(const AudioSample* input, float* output, size_t count) {
+    kernels().int16_to_float(input, output, count);
+}
+
+float peak(const AudioSample* input, size_t count) {
+    return kernels().peak(input, count);
+}
+
+float energy(const AudioSample* input, size_t count) {
+    return kernels().energy(input, count);
+}
+
+float rms(const AudioSample* input, size_t count) {
+    return std::sqrt(energy(input, count));
+}
+
+const char* kernel_name() {
+    return kernels().name;
+}
+
+} // namespace dsp
+} // namespace SuperWhisper
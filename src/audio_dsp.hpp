@@ -0,0 +1,37 @@
+#pragma once
+
+#include "audio_types.hpp"
+#include <cstddef>
+
+namespace SuperWhisper {
+namespace dsp {
+
+// Small audio DSP kernels shared by VAD (real-time callback) and transcription.
+// Each kernel has NEON, AVX2 and SSE2 implementations plus a scalar fallback;
+// the best one for the running CPU is picked once at first use.
+// All results are normalized to full scale (int16 / 32768).
+
+// Convert int16 PCM to float32 in [-1, 1)
+void int16_to_float(const AudioSample* input, float* output, size_t count);
+
+// Peak absolute amplitude
+float peak(const AudioSample* input, size_t count);
+
+// Mean signal energy (mean of squared samples)
+float energy(const AudioSample* input, size_t count);
+
+// Root mean square amplitude
+float rms(const AudioSample* input, size_t count);
+
+// Name of the implementation selected at runtime ("neon", "avx2", "sse2" or "scalar")
+const char* kernel_name();
+
+// Reference implementations, used as fallback and as benchmark baseline
+namespace scalar {
+void int16_to_float(const AudioSample* input, float* output, size_t count);
+float peak(const AudioSample* input, size_t count);
+float energy(const AudioSample* input, size_t count);
+} // namespace scalar
+
+} // namespace dsp
+} // namespace SuperWhisper
@@ -0,0 +1,200 @@
+#include "audio_file.hpp"
+#include "audio_dsp.hpp"
+#include "resampler.hpp"
+#include "posix_io.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace SuperWhisper {
+
+namespace {
+
+uint16_t read_u16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t read_u32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// One sample of any supported encoding as a float in [-1, 1]
+float decode_sample(const uint8_t* p, int format, int bits) {
+    if (format == 3) {  // IEEE float
+        float value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    switch (bits) {
+        case 8:
+            return (static_cast<int>(p[0]) - 128) / 128.0f;
+        case 16:
+            return static_cast<int16_t>(read_u16(p)) / 32768.0f;
+        case 24: {
+            int32_t value = static_cast<int32_t>((p[0] << 8) | (p[1] << 16) | (static_cast<uint32_t>(p[2]) << 24)) >> 8;
+            return value / 8388608.0f;
+        }
+        default:
+            return static_cast<int32_t>(read_u32(p)) / 2147483648.0f;
+    }
+}
+
+// Decode any format ffmpeg understands to 16 kHz mono s16le through a pipe
+bool decode_with_ffmpeg(const std::string& path, AudioFile& audio, std::string& error) {
+    constexpr int kDecodeRate = 16000;  // Whisper's native rate - no resampling needed later
+
+    // The pipe is close-on-exec, so an ffmpeg spawned at the same time by another batch
+    // I/O thread or daemon connection cannot hold this one's write end open
+    std::string pcm;
+    ProcessIo io;
+    io.output = &pcm;
+    const ProcessResult result = run_process({"ffmpeg", "-nostdin", "-v", "error", "-i", path, "-f", "s16le",
+                                              "-ac", "1", "-ar", std::to_string(kDecodeRate), "-"}, io);
+    if (!result.started) {
+        error = "not a WAV file and ffmpeg is not available to decode it";
+        return false;
+    }
+    if (!result.ok()) {
+        error = "ffmpeg failed to decode the file (exit status " + std::to_string(result.exit_code) + ")";
+        return false;
+    }
+
+    audio.sample_rate = kDecodeRate;
+    audio.samples.resize(pcm.size() / sizeof(AudioSample));
+    std::memcpy(audio.samples.data(), pcm.data(), audio.samples.size() * sizeof(AudioSample));
+    return true;
+}
+
+} // namespace
+
+void resample_audio_file(AudioFile& audio, int sample_rate) {
+    if (audio.sample_rate == sample_rate || audio.samples.empty()) return;
+
+    PolyphaseResampler resampler(audio.sample_rate, sample_rate);
+    std::vector<float> input(audio.samples.size());
+    dsp::int16_to_float(audio.samples.data(), input.data(), input.size());
+
+    std::vector<float> output(resampler.max_output(input.size()) + resampler.max_output(64));
+    size_t produced = resampler.process(input.data(), input.size(), output.data());
+    produced += resampler.flush(output.data() + produced);
+
+    audio.samples.resize(produced);
+    for (size_t i = 0; i < produced; ++i) {
+        const float scaled = std::clamp(output[i] * 32768.0f, -32768.0f, 32767.0f);
+        audio.samples[i] = static_cast<AudioSample>(std::lrint(scaled));
+    }
+    audio.sample_rate = sample_rate;
+}
+
+bool is_audio_file_extension(const std::string& path) {
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext == ".wav" || ext == ".flac" || ext == ".mp3" || ext == ".ogg" || ext == ".opus" || ext == ".m4a";
+}
+
+bool parse_wav(const uint8_t* data, size_t size, AudioFile& audio, std::string& error) {
+    if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) {
+        error = "not a RIFF/WAVE file";
+        return false;
+    }
+
+    int format = 0, channels = 0, bits = 0;
+    const uint8_t* samples = nullptr;
+    size_t samples_size = 0;
+
+    // Walk the chunk list for "fmt " and "data"
+    size_t offset = 12;
+    while (offset + 8 <= size) {
+        const uint8_t* chunk = data + offset;
+        const size_t chunk_size = read_u32(chunk + 4);
+        const size_t body = offset + 8;
+        const size_t available = std::min(chunk_size, size - body);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && available >= 16) {
+            format = read_u16(chunk + 8);
+            channels = read_u16(chunk + 10);
+            audio.sample_rate = static_cast<int>(read_u32(chunk + 12));
+            bits = read_u16(chunk + 22);
+            // WAVE_FORMAT_EXTENSIBLE stores the real format in the sub-format GUID
+            if (format == 0xFFFE && available >= 26) {
+                format = read_u16(chunk + 32);
+            }
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            samples = data + body;
+            samples_size = available;  // Streams written on the fly often leave the size at 0/-1
+            if (chunk_size == 0 || chunk_size == 0xFFFFFFFF) samples_size = size - body;
+            break;
+        }
+
+        offset = body + chunk_size + (chunk_size & 1);
+    }
+
+    const bool supported = (format == 1 && (bits == 8 || bits == 16 || bits == 24 || bits == 32)) ||
+                           (format == 3 && bits == 32);
+    if (!supported || channels <= 0 || audio.sample_rate <= 0) {
+        error = "unsupported WAV encoding (format " + std::to_string(format) + ", " + std::to_string(bits) + " bits)";
+        return false;
+    }
+    if (!samples) {
+        error = "WAV file has no data chunk";
+        return false;
+    }
+
+    const size_t frame_bytes = static_cast<size_t>(channels) * (bits / 8);
+    const size_t frames = samples_size / frame_bytes;
+    audio.samples.resize(frames);
+
+    if (format == 1 && bits == 16 && channels == 1) {
+        // Common case: already 16-bit mono
+        for (size_t i = 0; i < frames; ++i) {
+            audio.samples[i] = static_cast<AudioSample>(read_u16(samples + i * 2));
+        }
+        return true;
+    }
+
+    // Downmix to mono and requantize to 16-bit
+    for (size_t i = 0; i < frames; ++i) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            sum += decode_sample(samples + i * frame_bytes + c * (bits / 8), format, bits);
+        }
+        const float mono = std::clamp(sum / channels * 32768.0f, -32768.0f, 32767.0f);
+        audio.samples[i] = static_cast<AudioSample>(std::lrint(mono));
+    }
+
+    return true;
+}
+
+bool read_audio_file(const std::string& path, AudioFile& audio, std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    // Compressed formats go through ffmpeg - only WAV is read into memory here
+    char magic[4] = {};
+    file.read(magic, sizeof(magic));
+    bool decoded;
+    if (file.gcount() == 4 && std::memcmp(magic, "RIFF", 4) == 0) {
+        file.seekg(0);
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        decoded = parse_wav(bytes.data(), bytes.size(), audio, error);
+    } else {
+        decoded = decode_with_ffmpeg(path, audio, error);
+    }
+    if (!decoded) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+} // namespace SuperWhisper
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "audio_types.hpp"
+#include <string>
+
+namespace SuperWhisper {
+
+// Decoded audio file (mono, native sample rate)
+struct AudioFile {
+    AudioBuffer samples;
+    int sample_rate = 0;
+};
+
+// Read an audio file as mono 16-bit PCM. WAV (8/16/24/32-bit PCM or 32-bit float,
+// any channel count) is parsed natively at its own rate; anything else (FLAC, MP3,
+// Ogg, M4A, ...) is decoded to 16 kHz by an ffmpeg subprocess if ffmpeg is on PATH.
+// Returns false and fills error on failure.
+bool read_audio_file(const std::string& path, AudioFile& audio, std::string& error);
+
+// Resample a decoded file to sample_rate in place (no-op if it already matches)
+void resample_audio_file(AudioFile& audio, int sample_rate);
+
+// True for the extensions read_audio_file is expected to handle
+bool is_audio_file_extension(const std::string& path);
+
+// Parse an in-memory WAV image (same formats as read_audio_file)
+bool parse_wav(const uint8_t* data, size_t size, AudioFile& audio, std::string& error);
+
+} // namespace SuperWhisper
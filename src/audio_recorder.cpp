@@ -1,14 +1,73 @@
 #include "audio_recorder.hpp"
+#include "settings.hpp"
+#include "audio_dsp.hpp"
+#include "resampler.hpp"
 #include <portaudio.h>
 #include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <stdexcept>
 
 namespace SuperWhisper {
 
+namespace {
+
+std::string lowercase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+    return text;
+}
+
+std::string device_name(PaDeviceIndex device) {
+    const PaDeviceInfo* info = Pa_GetDeviceInfo(device);
+    const PaHostApiInfo* host = Pa_GetHostApiInfo(info->hostApi);
+    return std::string(info->name) + (host ? " (" + std::string(host->name) + ")" : "");
+}
+
+// Resolve input_device: "" is the default input, a number is a device index from
+// --list-devices, anything else the first input whose name contains it (any case)
+PaDeviceIndex find_input_device(const std::string& spec) {
+    if (spec.empty()) {
+        const PaDeviceIndex device = Pa_GetDefaultInputDevice();
+        if (device == paNoDevice) {
+            std::cerr << "No input device found" << std::endl;
+        }
+        return device;
+    }
+    
+    const PaDeviceIndex count = Pa_GetDeviceCount();
+    const bool numeric = std::all_of(spec.begin(), spec.end(), [](unsigned char c) { return std::isdigit(c); });
+    const long index = numeric ? std::strtol(spec.c_str(), nullptr, 10) : -1;
+    const std::string needle = lowercase(spec);
+    
+    for (PaDeviceIndex device = 0; device < count; ++device) {
+        const PaDeviceInfo* info = Pa_GetDeviceInfo(device);
+        if (!info || info->maxInputChannels < 1) continue;
+        
+        if (numeric ? device == index : lowercase(info->name).find(needle) != std::string::npos) {
+            return device;
+        }
+    }
+    
+    std::cerr << "Input device not found: " << spec << " (see --list-devices)" << std::endl;
+    return paNoDevice;
+}
+
+} // namespace
+
 class PortAudioRecorder : public AudioRecorder {
 public:
-    PortAudioRecorder() : stream_(nullptr), is_recording_(false), callback_(nullptr) {
+    explicit PortAudioRecorder(const Settings& settings)
+        : stream_(nullptr), is_recording_(false), callback_(nullptr),
+          input_device_(settings.input_device), frames_per_buffer_(settings.frames_per_buffer),
+          input_latency_ms_(settings.input_latency_ms), output_rate_(settings.sample_rate),
+          max_buffer_samples_(static_cast<size_t>(settings.sample_rate) * kMaxBufferSeconds),
+          preroll_samples_(std::min(max_buffer_samples_ / 2,
+                                    static_cast<size_t>(std::max(0, settings.preroll_ms)) * settings.sample_rate / 1000)),
+          ring_(max_buffer_samples_), start_pos_(0) {
         // Initialize PortAudio
         PaError err = Pa_Initialize();
         if (err != paNoError) {
@@ -18,36 +77,127 @@ public:
     
     ~PortAudioRecorder() override {
         stop();
+        close_stream();
         Pa_Terminate();
     }
     
     bool start() override {
         if (is_recording_) return false;
         
+        // Armed: the stream is already running, the recording starts preroll_ms back in the ring
+        if (armed_) {
+            const uint64_t now = ring_.write_position();
+            const uint64_t from = std::min(now, preroll_from_.load(std::memory_order_acquire));
+            start_pos_.store(now - std::min<uint64_t>(preroll_samples_, now - from), std::memory_order_release);
+            overflows_ = 0;
+            preroll_pending_.store(true, std::memory_order_release);
+            is_recording_ = true;
+            return true;
+        }
+        
+        if (!open_stream()) return false;
+        is_recording_ = true;
+        return true;
+    }
+    
+    void stop() override {
+        if (!is_recording_) return;
+        
+        // Armed: the stream keeps running, but the recording ends here
+        if (armed_) {
+            const uint64_t now = ring_.write_position();
+            stop_pos_.store(now, std::memory_order_release);
+            preroll_from_.store(now, std::memory_order_release);  // The next pre-roll starts after this one
+            preroll_pending_ = false;
+            is_recording_ = false;
+            return;
+        }
+        
+        is_recording_ = false;
+        close_stream();
+        stop_pos_.store(ring_.write_position(), std::memory_order_release);
+    }
+    
+    bool arm() override {
+        if (armed_) return true;
+        
+        // Set first: callbacks start as soon as the stream does
+        armed_ = true;
+        preroll_from_.store(ring_.write_position(), std::memory_order_release);
+        if (!open_stream()) {
+            armed_ = false;
+            return false;
+        }
+        return true;
+    }
+    
+    bool is_recording() const override {
+        return is_recording_;
+    }
+    
+    AudioBuffer get_audio() const override {
+        AudioView view = get_audio_view();
+        AudioBuffer audio(view.size());
+        view.copy_to(audio.data());
+        return audio;
+    }
+    
+    AudioView get_audio_view() const override {
+        // Sliding window over the newest samples since the last clear(), up to stop()
+        const uint64_t end = recording_end();
+        const uint64_t start = start_pos_.load(std::memory_order_acquire);
+        const AudioView view = ring_.view(std::max(start, end > max_buffer_samples_ ? end - max_buffer_samples_ : 0));
+        return view.subview(0, end > view.start ? static_cast<size_t>(end - view.start) : 0);
+    }
+    
+    bool has_audio() const override {
+        return recording_end() > start_pos_.load(std::memory_order_acquire);
+    }
+    
+    void clear() override {
+        // Storage is preallocated - just move the start of the recording forward
+        const uint64_t now = ring_.write_position();
+        start_pos_.store(now, std::memory_order_release);
+        stop_pos_.store(now, std::memory_order_release);
+    }
+    
+    void set_audio_callback(std::function<void(const AudioSample*, size_t)> callback) override {
+        callback_ = callback;
+    }
+    
+    int sample_rate() const override {
+        return output_rate_;
+    }
+    
+    CaptureStats capture_stats() const override {
+        CaptureStats stats = stats_;
+        stats.overflows = overflows_.load(std::memory_order_relaxed);
+        return stats;
+    }
+    
+private:
+    bool open_stream() {
         // Configure stream parameters for optimal performance
         PaStreamParameters input_params;
-        input_params.device = Pa_GetDefaultInputDevice();
+        input_params.device = find_input_device(input_device_);
         if (input_params.device == paNoDevice) {
-            std::cerr << "No input device found" << std::endl;
             return false;
         }
         
+        const PaDeviceInfo* device_info = Pa_GetDeviceInfo(input_params.device);
+        
         input_params.channelCount = 1;  // Mono for efficiency
         input_params.sampleFormat = paInt16;  // 16-bit for memory efficiency
-        input_params.suggestedLatency = Pa_GetDeviceInfo(input_params.device)->defaultLowInputLatency;
+        input_params.suggestedLatency = input_latency_ms_ > 0 ? input_latency_ms_ / 1000.0
+                                                              : device_info->defaultLowInputLatency;
         input_params.hostApiSpecificStreamInfo = nullptr;
         
-        // Open stream with optimal buffer size for Apple Silicon
-        PaError err = Pa_OpenStream(
-            &stream_,
-            &input_params,
-            nullptr,  // No output
-            16000,    // Sample rate
-            512,      // Frames per buffer - optimized for Apple Silicon
-            paClipOff | paDitherOff,  // Disable unnecessary processing
-            &PortAudioRecorder::pa_callback,
-            this
-        );
+        // Open the device at its native rate and resample in the callback, so the
+        // host API does no (low quality) conversion and nothing is left for after stop
+        PaError err = open_pa_stream(input_params, static_cast<int>(device_info->defaultSampleRate));
+        if (err != paNoError && static_cast<int>(device_info->defaultSampleRate) != output_rate_) {
+            err = open_pa_stream(input_params, output_rate_);
+        }
         
         if (err != paNoError) {
             std::cerr << "Failed to open stream: " << Pa_GetErrorText(err) << std::endl;
@@ -63,15 +213,27 @@ public:
             return false;
         }
         
-        is_recording_ = true;
+        // What the host API actually granted, reported once per device
+        const PaStreamInfo* stream_info = Pa_GetStreamInfo(stream_);
+        const std::string device = device_name(input_params.device);
+        const bool changed = device != stats_.device;
+        stats_.device = device;
+        stats_.device_rate = stream_info ? static_cast<int>(stream_info->sampleRate) : capture_rate_;
+        stats_.frames_per_buffer = capture_frames_;
+        stats_.input_latency_ms = stream_info ? stream_info->inputLatency * 1000.0 : 0.0;
+        overflows_ = 0;
+        
+        if (changed) {
+            char line[160];
+            std::snprintf(line, sizeof(line), "%d Hz, %lu frames/buffer (%.1f ms), %.1f ms input latency",
+                          stats_.device_rate, stats_.frames_per_buffer,
+                          1000.0 * stats_.frames_per_buffer / std::max(1, stats_.device_rate), stats_.input_latency_ms);
+            std::cout << "Capture: " << stats_.device << ", " << line << std::endl;
+        }
         return true;
     }
     
-    void stop() override {
-        if (!is_recording_) return;
-        
-        is_recording_ = false;
-        
+    void close_stream() {
         if (stream_) {
             Pa_StopStream(stream_);
             Pa_CloseStream(stream_);
@@ -79,26 +241,41 @@ public:
         }
     }
     
-    bool is_recording() const override {
-        return is_recording_;
-    }
-    
-    AudioBuffer get_audio() const override {
-        std::lock_guard<std::mutex> lock(buffer_mutex_);
-        return audio_buffer_;
-    }
-    
-    void clear() override {
-        std::lock_guard<std::mutex> lock(buffer_mutex_);
-        audio_buffer_.clear();
-        audio_buffer_.shrink_to_fit();  // Free memory
+    // A running recording extends to the newest sample, a stopped one ends at stop()
+    uint64_t recording_end() const {
+        return is_recording_ ? ring_.write_position() : stop_pos_.load(std::memory_order_acquire);
     }
     
-    void set_audio_callback(std::function<void(const AudioSample*, size_t)> callback) override {
-        callback_ = callback;
+    PaError open_pa_stream(const PaStreamParameters& input_params, int capture_rate) {
+        if (capture_rate <= 0) capture_rate = output_rate_;
+        
+        // Resampler and scratch buffers are set up here so the callback never allocates
+        resampler_.reset();
+        if (capture_rate != output_rate_) {
+            resampler_ = std::make_unique<PolyphaseResampler>(capture_rate, output_rate_);
+            capture_float_.resize(kMaxCallbackFrames);
+            resampled_float_.resize(resampler_->max_output(kMaxCallbackFrames));
+            resampled_pcm_.resize(resampled_float_.size());
+        }
+        
+        // By default keep the callback period at 512 frames of 16 kHz (32 ms) whatever the device rate
+        capture_rate_ = capture_rate;
+        capture_frames_ = frames_per_buffer_ > 0 ? static_cast<unsigned long>(frames_per_buffer_)
+                                                 : 512UL * capture_rate / 16000;
+        
+        return Pa_OpenStream(
+            &stream_,
+            &input_params,
+            nullptr,  // No output
+            capture_rate,
+            capture_frames_,
+            paClipOff | paDitherOff,  // Disable unnecessary processing
+            &PortAudioRecorder::pa_callback,
+            this
+        );
     }
     
-private:
+
     // PortAudio callback - highly optimized for Apple Silicon
     static int pa_callback(const void* input, void* output,
                           unsigned long frameCount,
@@ -107,53 +284,158 @@ private:
                           void* userData) {
         auto* recorder = static_cast<PortAudioRecorder*>(userData);
         
+        // Audio was lost before this buffer (the callback fell behind); this one is still good
         if (statusFlags & paInputOverflow) {
-            // Handle overflow gracefully
-            return paContinue;
+            recorder->overflows_.fetch_add(1, std::memory_order_relaxed);
         }
         
-        if (input && recorder->callback_) {
+        if (input) {
             // Process audio data efficiently
             const AudioSample* samples = static_cast<const AudioSample*>(input);
             
-            // Use callback for real-time processing
-            recorder->callback_(samples, frameCount);
-            
-            // Also store in buffer for transcription
-            recorder->add_audio_chunk(samples, frameCount);
+            if (recorder->resampler_) {
+                recorder->resample_and_deliver(samples, frameCount);
+            } else {
+                recorder->deliver(samples, frameCount);
+            }
         }
         
         return paContinue;
     }
     
-    void add_audio_chunk(const AudioSample* samples, size_t count) {
-        std::lock_guard<std::mutex> lock(buffer_mutex_);
+    void deliver(const AudioSample* samples, size_t count) {
+        // Armed between recordings: the ring only holds the next pre-roll
+        if (armed_ && !is_recording_) {
+            add_preroll_chunk(samples, count);
+            return;
+        }
         
-        // Memory-efficient buffer management
-        const size_t max_buffer_size = 16000 * 30;  // 30 seconds max
+        // A recording's pre-roll reaches the consumer first, on this thread like the rest
+        if (preroll_pending_.load(std::memory_order_relaxed) && preroll_pending_.exchange(false)) {
+            const AudioView preroll = ring_.view(start_pos_.load(std::memory_order_acquire));
+            if (callback_ && !preroll.first.empty()) callback_(preroll.first.data(), preroll.first.size());
+            if (callback_ && !preroll.second.empty()) callback_(preroll.second.data(), preroll.second.size());
+        }
         
-        if (audio_buffer_.size() + count > max_buffer_size) {
-            // Remove oldest samples (sliding window)
-            size_t remove_count = audio_buffer_.size() + count - max_buffer_size;
-            audio_buffer_.erase(audio_buffer_.begin(), audio_buffer_.begin() + remove_count);
+        // Use callback for real-time processing (optional - headless capture only needs the ring)
+        if (callback_) {
+            callback_(samples, count);
         }
         
-        // Add new samples
-        audio_buffer_.insert(audio_buffer_.end(), samples, samples + count);
+        // Also store in buffer for transcription
+        add_audio_chunk(samples, count);
+    }
+    
+    // Native rate -> output rate, incrementally, using the preallocated scratch buffers
+    void resample_and_deliver(const AudioSample* samples, size_t count) {
+        while (count > 0) {
+            const size_t block = std::min(count, kMaxCallbackFrames);
+            dsp::int16_to_float(samples, capture_float_.data(), block);
+            
+            const size_t produced = resampler_->process(capture_float_.data(), block, resampled_float_.data());
+            for (size_t i = 0; i < produced; ++i) {
+                const float scaled = std::clamp(resampled_float_[i] * 32768.0f, -32768.0f, 32767.0f);
+                resampled_pcm_[i] = static_cast<AudioSample>(std::lrint(scaled));
+            }
+            
+            if (produced > 0) {
+                deliver(resampled_pcm_.data(), produced);
+            }
+            samples += block;
+            count -= block;
+        }
+    }
+    
+    void add_audio_chunk(const AudioSample* samples, size_t count) {
+        // Wait-free: no lock and no allocation on the audio thread. Once the
+        // 30 s window is full the ring simply overwrites the oldest samples.
+        ring_.write(samples, count);
     }
     
+    void add_preroll_chunk(const AudioSample* samples, size_t count) {
+        // A stopped recording nobody has cleared yet is never overwritten: the audio is
+        // dropped instead, and the pre-roll restarts after the gap
+        const uint64_t start = start_pos_.load(std::memory_order_acquire);
+        const uint64_t pos = ring_.write_position();
+        if (stop_pos_.load(std::memory_order_acquire) > start && pos + count - start > ring_.capacity()) {
+            preroll_from_.store(pos, std::memory_order_release);
+            return;
+        }
+        ring_.write(samples, count);
+    }
+    
+    // 30 seconds max (the ring rounds this up to a power of two)
+    static constexpr size_t kMaxBufferSeconds = 30;
+    
+    // Largest block converted at once in the callback (longer callbacks are split)
+    static constexpr size_t kMaxCallbackFrames = 4096;
+    
     PaStream* stream_;
     std::atomic<bool> is_recording_;
     std::function<void(const AudioSample*, size_t)> callback_;
     
-    // Thread-safe audio buffer
-    mutable std::mutex buffer_mutex_;
-    AudioBuffer audio_buffer_;
+    // Device selection and buffering
+    const std::string input_device_;
+    const int frames_per_buffer_;        // 0 = 32 ms at the device rate
+    const float input_latency_ms_;       // 0 = the device's default low latency
+    int capture_rate_ = 0;
+    unsigned long capture_frames_ = 0;
+    CaptureStats stats_;
+    std::atomic<uint64_t> overflows_{0};
+    
+    // Capture-side resampling from the device's native rate
+    const int output_rate_;
+    std::unique_ptr<PolyphaseResampler> resampler_;
+    std::vector<float> capture_float_;
+    std::vector<float> resampled_float_;
+    AudioBuffer resampled_pcm_;
+    
+    // Lock-free capture buffer (producer: audio callback, readers: everything else)
+    const size_t max_buffer_samples_;
+    const size_t preroll_samples_;
+    SpscRingBuffer<AudioSample> ring_;
+    std::atomic<uint64_t> start_pos_;
+    std::atomic<uint64_t> stop_pos_{0};
+    
+    // Always-armed capture: the stream runs between recordings
+    bool armed_ = false;
+    std::atomic<uint64_t> preroll_from_{0};     // Earliest position a pre-roll may reach back to
+    std::atomic<bool> preroll_pending_{false};  // Started, pre-roll not yet passed to the callback
 };
 
 // Factory function
-std::unique_ptr<AudioRecorder> create_audio_recorder() {
-    return std::make_unique<PortAudioRecorder>();
+std::unique_ptr<AudioRecorder> create_audio_recorder(const Settings& settings) {
+    if (!settings.audio_input.empty()) {
+        return create_stream_recorder(settings);
+    }
+    return std::make_unique<PortAudioRecorder>(settings);
+}
+
+bool print_input_devices() {
+    PaError err = Pa_Initialize();
+    if (err != paNoError) {
+        std::cerr << "Failed to initialize PortAudio: " << Pa_GetErrorText(err) << std::endl;
+        return false;
+    }
+    
+    const PaDeviceIndex default_device = Pa_GetDefaultInputDevice();
+    const PaDeviceIndex count = Pa_GetDeviceCount();
+    std::cout << "Input devices (select with input_device = index or part of the name):\n";
+    for (PaDeviceIndex device = 0; device < count; ++device) {
+        const PaDeviceInfo* info = Pa_GetDeviceInfo(device);
+        if (!info || info->maxInputChannels < 1) continue;
+        
+        char line[160];
+        std::snprintf(line, sizeof(line), "%d ch, %.0f Hz, latency %.1f ms low / %.1f ms high",
+                      info->maxInputChannels, info->defaultSampleRate,
+                      info->defaultLowInputLatency * 1000.0, info->defaultHighInputLatency * 1000.0);
+        std::cout << "  [" << device << "] " << device_name(device) << " - " << line
+                  << (device == default_device ? " (default)" : "") << "\n";
+    }
+    std::cout << std::flush;
+    
+    Pa_Terminate();
+    return true;
 }
 
 } // namespace SuperWhisper
@@ -1,14 +1,23 @@
 #pragma once
 
+#include "audio_types.hpp"
+#include <cstdint>
 #include <memory>
-#include <vector>
 #include <functional>
+#include <string>
 
 namespace SuperWhisper {
 
-// Audio sample type - using 16-bit for memory efficiency
-using AudioSample = int16_t;
-using AudioBuffer = std::vector<AudioSample>;
+struct Settings;
+
+// What the capture stream actually got from the device (zeroed until it is opened)
+struct CaptureStats {
+    std::string device;               // Device and host API name
+    int device_rate = 0;              // Rate the device runs at (resampled to sample_rate())
+    unsigned long frames_per_buffer = 0;
+    double input_latency_ms = 0.0;    // Latency reported by the opened stream
+    uint64_t overflows = 0;           // Input overflows (dropped audio) in the current recording
+};
 
 // Audio recorder interface
 class AudioRecorder {
@@ -21,11 +30,43 @@ public:
     virtual AudioBuffer get_audio() const = 0;
     virtual void clear() = 0;
     
+    // Zero-copy view of the recorded audio - valid until more than the buffer capacity is recorded
+    virtual AudioView get_audio_view() const = 0;
+    virtual bool has_audio() const = 0;
+    
+    // Rate of the delivered audio (the device's native rate is resampled to this)
+    virtual int sample_rate() const = 0;
+    
     // Memory-efficient streaming interface
     virtual void set_audio_callback(std::function<void(const AudioSample*, size_t)> callback) = 0;
+    
+    // Device, buffer size, latency and overflows of the capture stream
+    virtual CaptureStats capture_stats() const { return {}; }
+    
+    // Keep the capture stream running between recordings (always_armed): start() and stop()
+    // then only mark positions in the ring, and a recording begins with the preroll_ms of
+    // audio before start(). False if the stream cannot be opened or the source has no device.
+    virtual bool arm() { return false; }
+    
+    // Piped sources deliver audio as fast as it is read rather than in real time, so
+    // recording limits are measured in samples; they can also run out, which the end
+    // callback reports (on the reader thread). They may be stopped from the audio
+    // callback, so an utterance ends exactly where the limit was hit. Live devices never end.
+    virtual bool is_live() const { return true; }
+    virtual bool at_end() const { return false; }
+    virtual void set_end_callback(std::function<void()> callback) {}
 };
 
-// Factory function for creating audio recorder
-std::unique_ptr<AudioRecorder> create_audio_recorder();
+// Factory function for creating audio recorder delivering settings.sample_rate audio:
+// the default input device, or settings.audio_input when it is set
+std::unique_ptr<AudioRecorder> create_audio_recorder(const Settings& settings);
+
+// Print every input device with its index, host API, channels, default rate and latencies
+// (--list-devices). Returns false if PortAudio cannot be initialized.
+bool print_input_devices();
+
+// Recorder reading settings.audio_input ("-" for stdin, a FIFO or a Unix socket path).
+// nullptr if it cannot be opened.
+std::unique_ptr<AudioRecorder> create_stream_recorder(const Settings& settings);
 
 } // namespace SuperWhisper
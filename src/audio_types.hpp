@@ -0,0 +1,16 @@
+#pragma once
+
+#include "ring_buffer.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace SuperWhisper {
+
+// Audio sample type - using 16-bit for memory efficiency
+using AudioSample = int16_t;
+using AudioBuffer = std::vector<AudioSample>;
+
+// Zero-copy view of captured audio (up to two contiguous spans)
+using AudioView = RingView<AudioSample>;
+
+} // namespace SuperWhisper
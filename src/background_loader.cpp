@@ -0,0 +1,152 @@
+#include "background_loader.hpp"
+#include "settings.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace SuperWhisper {
+
+namespace {
+
+// Enough audio for one encoder pass and a decoder step
+constexpr int kWarmupSamples = 16000 / 2;
+
+class BackgroundLoader : public BackgroundLoadWrapper {
+public:
+    BackgroundLoader(std::unique_ptr<WhisperWrapper> inner, const Settings& settings, ModelLoadedHook on_loaded)
+        : inner_(std::move(inner)), warmup_settings_(settings), on_loaded_(std::move(on_loaded)) {
+        // The cheapest decode that still runs every kernel: VAD would skip the silence
+        warmup_settings_.vad_trim_silence = false;
+        warmup_settings_.print_progress = false;
+        warmup_settings_.max_tokens = 1;
+        warmup_settings_.best_of = 1;
+        warmup_settings_.temperature_inc = 0.0f;
+        warmup_settings_.single_segment = true;
+        warmup_settings_.no_timestamps = true;
+    }
+
+    ~BackgroundLoader() override {
+        join();
+    }
+
+    bool load_model(const std::string& path, const ModelLoadOptions& options) override {
+        join();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            state_ = State::Loading;
+        }
+
+        loader_ = std::thread([this, path, options]() {
+            const auto start = std::chrono::steady_clock::now();
+            bool ok = inner_->load_model(path, options);
+            if (on_loaded_) ok = on_loaded_(ok, *inner_) && ok;
+            const auto loaded = std::chrono::steady_clock::now();
+
+            if (ok) {
+                const AudioBuffer silence(kWarmupSamples, 0);
+                inner_->transcribe_segments(silence, 16000, warmup_settings_);
+
+                char line[96];
+                std::snprintf(line, sizeof(line), "Model ready: loaded in %.0f ms, warm-up decode %.0f ms",
+                              std::chrono::duration<double, std::milli>(loaded - start).count(),
+                              std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loaded).count());
+                std::cout << line << std::endl;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                state_ = ok ? State::Ready : State::Failed;
+            }
+            ready_.notify_all();
+        });
+        return true;
+    }
+
+    bool wait_until_loaded() override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [this]() { return state_ != State::Loading; });
+        return state_ == State::Ready;
+    }
+
+    bool is_loaded() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return state_ == State::Ready && inner_->is_loaded();
+    }
+
+    size_t reserve(size_t max_samples, int sample_rate) override {
+        return wait_until_loaded() ? inner_->reserve(max_samples, sample_rate) : 0;
+    }
+
+    const std::string& transcribe(const AudioView& audio, int sample_rate, const Settings& settings) override {
+        return wait_until_loaded() ? inner_->transcribe(audio, sample_rate, settings) : empty_;
+    }
+
+    TranscriptSegments transcribe_segments(const AudioView& audio, int sample_rate, const Settings& settings) override {
+        return wait_until_loaded() ? inner_->transcribe_segments(audio, sample_rate, settings) : TranscriptSegments{};
+    }
+
+    // The inner wrapper is only touched by the loader thread until loading finishes
+    void set_context_tokens(int max_tokens) override {
+        wait_until_loaded();
+        inner_->set_context_tokens(max_tokens);
+    }
+
+    void commit_context(const std::string& text) override {
+        wait_until_loaded();
+        inner_->commit_context(text);
+    }
+
+    void reset_context() override {
+        wait_until_loaded();
+        inner_->reset_context();
+    }
+
+    void set_segment_callback(SegmentCallback callback) override {
+        wait_until_loaded();
+        inner_->set_segment_callback(std::move(callback));
+    }
+
+    DecodeTimings last_timings() const override {
+        const_cast<BackgroundLoader*>(this)->wait_until_loaded();
+        return inner_->last_timings();
+    }
+
+    void unload_model() override {
+        join();  // A load in progress cannot be interrupted
+        inner_->unload_model();
+    }
+
+    MemoryStats memory_stats() const override {
+        const_cast<BackgroundLoader*>(this)->wait_until_loaded();
+        return inner_->memory_stats();
+    }
+
+private:
+    enum class State { Idle, Loading, Ready, Failed };
+
+    void join() {
+        if (loader_.joinable()) loader_.join();
+    }
+
+    std::unique_ptr<WhisperWrapper> inner_;
+    Settings warmup_settings_;
+    ModelLoadedHook on_loaded_;
+    const std::string empty_;
+
+    std::thread loader_;
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    State state_ = State::Idle;
+};
+
+} // namespace
+
+std::unique_ptr<BackgroundLoadWrapper> create_background_loader(std::unique_ptr<WhisperWrapper> inner,
+                                                                const Settings& settings, ModelLoadedHook on_loaded) {
+    return std::make_unique<BackgroundLoader>(std::move(inner), settings, std::move(on_loaded));
+}
+
+} // namespace SuperWhisper
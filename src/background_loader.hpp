@@ -0,0 +1,29 @@
+#pragma once
+
+#include "whisper_wrapper.hpp"
+#include <functional>
+#include <memory>
+
+namespace SuperWhisper {
+
+struct Settings;
+
+// Loads a wrapper's model on a background thread, so capture can start at once.
+// load_model() returns immediately; every call that needs the model waits until
+// the load, the owner's setup hook and a short warm-up decode (which compiles the
+// GPU kernels - Metal pipelines - ahead of the first real request) have finished.
+class BackgroundLoadWrapper : public WhisperWrapper {
+public:
+    // Block until loading has finished; false if it failed
+    virtual bool wait_until_loaded() = 0;
+};
+
+// Runs on the loader thread once inner's load_model() returned `loaded`; finishes setup
+// on the loaded wrapper (reserve, budget checks, ...). False marks the model unusable.
+using ModelLoadedHook = std::function<bool(bool loaded, WhisperWrapper& inner)>;
+
+// Factory function - settings are those the warm-up decode runs with
+std::unique_ptr<BackgroundLoadWrapper> create_background_loader(std::unique_ptr<WhisperWrapper> inner,
+                                                                const Settings& settings, ModelLoadedHook on_loaded);
+
+} // namespace SuperWhisper
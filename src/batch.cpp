@@ -0,0 +1,271 @@
+#include "batch.hpp"
+#include "settings.hpp"
+#include "audio_file.hpp"
+#include "metrics.hpp"
+#include "result_cache.hpp"
+#include "segment_sink.hpp"
+#include "vad.hpp"
+#include "whisper_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <semaphore>
+#include <stdexcept>
+#include <thread>
+
+namespace SuperWhisper {
+
+namespace {
+
+// Decode threads; file decode is mostly ffmpeg or disk bound, two keep the pool fed
+constexpr int kIoThreads = 2;
+
+// Rate the decode contexts run at - resampling happens on the I/O threads
+constexpr int kWhisperRate = 16000;
+
+// Transcript file of one input, written segment by segment from the pool thread
+// as they are decoded; the writer stage only closes it
+struct BatchOutput {
+    std::string path;
+    std::ofstream file;
+    const SegmentSink* sink = nullptr;
+    std::string buffer;   // One segment at a time, reused
+    size_t segments = 0;
+
+    void write(const TranscriptSegment& segment) {
+        buffer.clear();
+        sink->write(segment, segments++, buffer);
+        file << buffer;
+    }
+};
+
+// A decoded file handed from the I/O threads to the writer
+struct BatchItem {
+    size_t index = 0;
+    std::string error;              // Non-empty if decoding failed
+    double audio_seconds = 0.0;
+    bool has_speech = true;         // False: VAD found nothing, no job was queued
+    bool cached = false;            // Served from the result cache, already written
+    std::string cache_key;          // Set when the result should be stored
+    std::shared_ptr<BatchOutput> output;
+    std::future<TranscriptSegments> result;
+};
+
+// Expand directories (recursively) into the audio files they contain
+std::vector<std::string> collect_inputs(const std::vector<std::string>& inputs) {
+    std::vector<std::string> files;
+
+    for (const auto& input : inputs) {
+        std::error_code ec;
+        if (std::filesystem::is_directory(input, ec)) {
+            std::vector<std::string> found;
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(input, ec)) {
+                if (entry.is_regular_file() && is_audio_file_extension(entry.path().string())) {
+                    found.push_back(entry.path().string());
+                }
+            }
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        } else {
+            files.push_back(input);
+        }
+    }
+
+    return files;
+}
+
+std::string output_path(const std::string& input, const std::string& format) {
+    const bool known = format == "json" || format == "srt" || format == "vtt" || format == "csv";
+    return std::filesystem::path(input).replace_extension(known ? "." + format : ".txt").string();
+}
+
+// Create the transcript file and write its header, before the job is queued
+bool open_output(const std::string& input, const std::string& format, BatchItem& item) {
+    auto output = std::make_shared<BatchOutput>();
+    output->path = output_path(input, format);
+    output->file.open(output->path);
+    if (!output->file.is_open()) {
+        item.error = "cannot write " + output->path;
+        return false;
+    }
+
+    output->sink = &get_segment_sink(format);
+    output->sink->begin(output->buffer);
+    output->file << output->buffer;
+    item.output = std::move(output);
+    return true;
+}
+
+} // namespace
+
+int run_batch(const Settings& settings, const std::vector<std::string>& inputs) {
+    const std::vector<std::string> files = collect_inputs(inputs);
+    if (files.empty()) {
+        std::cerr << "No audio files to transcribe" << std::endl;
+        return 1;
+    }
+
+    auto pool = create_whisper_pool(settings.pool_size);
+    if (!pool->load_model(settings.model_path, model_load_options(settings))) {
+        std::cerr << "Failed to load Whisper model: " << settings.model_path << std::endl;
+        return 1;
+    }
+    if (!check_memory_budget(pool->memory_stats(), settings.memory_budget_mb)) {
+        return 1;
+    }
+
+    // Several contexts printing progress at once is just noise
+    Settings job_settings = settings;
+    job_settings.print_progress = false;
+    apply_decode_preset(job_settings, false);
+
+    // Bound decoded-but-unwritten files: enough to keep every context busy with
+    // one more job queued behind it, without decoding a whole directory into RAM
+    std::counting_semaphore<> slots(static_cast<std::ptrdiff_t>(pool->size() * 2));
+
+    // Re-running over a directory only decodes the files that changed
+    auto cache = create_result_cache(settings);
+
+    std::atomic<size_t> next_file{0};
+    std::mutex ready_mutex;
+    std::condition_variable ready_cv;
+    std::deque<BatchItem> ready;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // I/O stage: decode -> resample -> VAD -> submit to the pool
+    std::vector<std::thread> io_threads;
+    for (int t = 0; t < std::min<int>(kIoThreads, static_cast<int>(files.size())); ++t) {
+        io_threads.emplace_back([&]() {
+            auto vad = create_vad(settings);
+
+            for (size_t index = next_file++; index < files.size(); index = next_file++) {
+                slots.acquire();
+
+                BatchItem item;
+                item.index = index;
+
+                AudioFile audio;
+                if (read_audio_file(files[index], audio, item.error) && open_output(files[index], settings.output_format, item)) {
+                    resample_audio_file(audio, kWhisperRate);
+                    item.audio_seconds = static_cast<double>(audio.samples.size()) / kWhisperRate;
+
+                    if (cache) {
+                        item.cache_key = result_cache_key(AudioView{audio.samples, {}, 0}, kWhisperRate, job_settings);
+                        TranscriptSegments segments;
+                        if (cache->lookup(item.cache_key, segments)) {
+                            for (const auto& segment : segments) {
+                                item.output->write(segment);
+                            }
+                            item.cached = true;
+                        }
+                    }
+
+                    // Files without any speech never occupy a decode context; the regions go
+                    // along with the job so the decode trims to them without a second VAD pass
+                    SpeechRegions speech;
+                    if (!item.cached && settings.vad_trim_silence) {
+                        speech = vad->detect(AudioView{audio.samples, {}, 0}, kWhisperRate);
+                        item.has_speech = !speech.empty();
+                    }
+                    if (item.has_speech && !item.cached) {
+                        item.result = pool->submit(std::move(audio.samples), kWhisperRate, job_settings, std::move(speech),
+                                                   [output = item.output](const TranscriptSegment& segment) {
+                                                       output->write(segment);
+                                                   });
+                    }
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(ready_mutex);
+                    ready.push_back(std::move(item));
+                }
+                ready_cv.notify_one();
+            }
+        });
+    }
+
+    // Writer stage (this thread): take the items in the order the I/O threads queued them,
+    // waiting on each decode in turn, so a slow file holds back the ones behind it
+    size_t failed = 0;
+    double total_audio = 0.0;
+
+    for (size_t done = 0; done < files.size(); ++done) {
+        BatchItem item;
+        {
+            std::unique_lock<std::mutex> lock(ready_mutex);
+            ready_cv.wait(lock, [&]() { return !ready.empty(); });
+            item = std::move(ready.front());
+            ready.pop_front();
+        }
+
+        const std::string& input = files[item.index];
+        const std::string progress = "[" + std::to_string(done + 1) + "/" + std::to_string(files.size()) + "] ";
+
+        try {
+            if (!item.error.empty()) {
+                throw std::runtime_error(item.error);
+            }
+
+            // The segments are already in the file. Only what the model decoded is cached:
+            // a file VAD rejected is checked again next run rather than remembered as silent
+            if (item.has_speech && !item.cached) {
+                const TranscriptSegments segments = item.result.get();
+                if (cache) cache->store(item.cache_key, segments);
+            }
+
+            BatchOutput& output = *item.output;
+            output.buffer.clear();
+            output.sink->end(output.buffer);
+            output.file << output.buffer << std::endl;
+            output.file.close();
+            if (output.file.fail()) {
+                throw std::runtime_error("cannot write " + output.path);
+            }
+
+            total_audio += item.audio_seconds;
+            metrics::add(metrics::Counter::Utterances);
+            metrics::add(metrics::Counter::AudioMs, static_cast<uint64_t>(item.audio_seconds * 1000.0));
+            std::cout << progress << input << " (" << std::lround(item.audio_seconds) << "s"
+                      << (item.has_speech ? "" : ", no speech") << (item.cached ? ", cached" : "") << ") -> " << output.path << std::endl;
+        } catch (const std::exception& e) {
+            ++failed;
+            std::cerr << progress << "Failed: " << e.what() << std::endl;
+
+            // Don't leave a partial transcript behind
+            if (item.output) {
+                item.output->file.close();
+                std::error_code ec;
+                std::filesystem::remove(item.output->path, ec);
+            }
+        }
+
+        slots.release();
+    }
+
+    for (auto& thread : io_threads) {
+        thread.join();
+    }
+
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    char summary[160];
+    std::snprintf(summary, sizeof(summary), "%.1fs of audio in %.1fs - RTF %.3f (%.1fx real-time)",
+                  total_audio, wall, total_audio > 0 ? wall / total_audio : 0.0, wall > 0 ? total_audio / wall : 0.0);
+
+    std::cout << "\nBatch complete: " << files.size() - failed << "/" << files.size() << " files, " << summary << std::endl;
+    if (cache) {
+        std::cout << "Result cache: " << format_cache_stats(cache->stats()) << std::endl;
+    }
+    return failed == 0 ? 0 : 1;
+}
+
+} // namespace SuperWhisper
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace SuperWhisper {
+
+struct Settings;
+
+// Transcribe files and/or directories (searched recursively for audio files).
+// Decoding, resampling and VAD run on I/O threads and overlap with inference on a
+// WhisperPool of settings.pool_size contexts. Each result is written next to its
+// input in settings.output_format (.txt, .json, .srt, .vtt, .csv); the overall
+// real-time factor is printed at the end. Returns the process exit code.
+int run_batch(const Settings& settings, const std::vector<std::string>& inputs);
+
+} // namespace SuperWhisper
@@ -0,0 +1,135 @@
+#include "calibrate.hpp"
+#include "settings.hpp"
+#include "audio_file.hpp"
+#include "system_info.hpp"
+#include "whisper_wrapper.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace SuperWhisper {
+
+namespace {
+
+constexpr const char* kDefaultClip = "external/whisper.cpp/samples/jfk.wav";
+constexpr int kClipSeconds = 10;   // Long enough for a stable timing, short enough to sweep quickly
+constexpr int kRuns = 3;           // Median of this many transcriptions per configuration
+constexpr double kTolerance = 0.03;  // Within 3% of the fastest counts as a tie
+
+struct Candidate {
+    bool use_gpu = false;
+    int threads = 0;
+    double ms = 0.0;
+};
+
+// Powers of two and the usual core counts, plus this machine's P-core and logical CPU
+// counts (the best setting is usually one of those two)
+std::vector<int> thread_counts() {
+    const int logical = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    std::vector<int> counts = {performance_core_count(), logical};
+    for (int n : {1, 2, 4, 6, 8, 12, 16}) {
+        if (n <= logical) counts.push_back(n);
+    }
+    std::sort(counts.begin(), counts.end());
+    counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+    return counts;
+}
+
+double median_ms(WhisperWrapper& whisper, const AudioBuffer& clip, const Settings& settings) {
+    std::vector<double> times;
+    for (int run = 0; run < kRuns; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        whisper.transcribe_segments(clip, 16000, settings);
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+} // namespace
+
+int run_calibration(Settings& settings, const std::string& config_path, const std::string& audio_path) {
+    const std::string clip_path = audio_path.empty() ? kDefaultClip : audio_path;
+    AudioFile audio;
+    std::string error;
+    if (!read_audio_file(clip_path, audio, error)) {
+        std::cerr << error << "\nPass a short speech recording: --calibrate FILE" << std::endl;
+        return 1;
+    }
+    resample_audio_file(audio, 16000);
+    AudioBuffer clip = std::move(audio.samples);
+    clip.resize(std::min(clip.size(), static_cast<size_t>(kClipSeconds) * 16000));
+    const double clip_seconds = clip.size() / 16000.0;
+
+    Settings run_settings = settings;
+    run_settings.print_progress = false;
+    apply_decode_preset(run_settings, true);
+
+    const std::vector<int> threads = thread_counts();
+    std::cout << "Calibrating on " << clip_path << " (" << clip_seconds << "s), " << performance_core_count()
+              << " performance cores, " << std::thread::hardware_concurrency() << " logical CPUs" << std::endl;
+
+    std::vector<Candidate> results;
+    for (const bool use_gpu : {true, false}) {
+        ModelLoadOptions options;
+        options.use_gpu = use_gpu;
+
+        auto whisper = create_whisper_wrapper();
+        if (!whisper->load_model(settings.model_path, options)) {
+            std::cerr << "Skipping " << (use_gpu ? "GPU" : "CPU") << " backend: model failed to load" << std::endl;
+            continue;
+        }
+
+        // The first decode pays one-off allocation and (on Metal) pipeline compilation
+        run_settings.num_threads = threads.back();
+        whisper->transcribe_segments(clip, 16000, run_settings);
+
+        for (const int n : threads) {
+            run_settings.num_threads = n;
+            const double ms = median_ms(*whisper, clip, run_settings);
+            results.push_back({use_gpu, n, ms});
+
+            char line[96];
+            std::snprintf(line, sizeof(line), "  %s %2d threads: %8.1f ms (RTF %.3f)", use_gpu ? "GPU" : "CPU", n, ms,
+                          clip_seconds > 0 ? ms / 1000.0 / clip_seconds : 0.0);
+            std::cout << line << std::endl;
+        }
+    }
+
+    if (results.empty()) {
+        std::cerr << "Calibration failed: no backend could load " << settings.model_path << std::endl;
+        return 1;
+    }
+
+    // Among the near-fastest, fewer threads leave more of the machine to everything else
+    const double fastest = std::min_element(results.begin(), results.end(),
+                                            [](const Candidate& a, const Candidate& b) { return a.ms < b.ms; })->ms;
+    const Candidate* best = nullptr;
+    for (const auto& candidate : results) {
+        if (candidate.ms > fastest * (1.0 + kTolerance)) continue;
+        if (!best || candidate.threads < best->threads) best = &candidate;
+    }
+
+    settings.num_threads = best->threads;
+    settings.use_gpu = best->use_gpu;
+#ifdef __APPLE__
+    if (best->use_gpu) settings.use_metal = true;
+#endif
+
+    // Only the tuned fields change on disk - command line overrides (--model, ...) are not persisted
+    Settings saved;
+    saved.load(config_path, true);
+    saved.num_threads = settings.num_threads;
+    saved.use_gpu = settings.use_gpu;
+    saved.use_metal = settings.use_metal;
+    saved.save(config_path);
+
+    std::cout << "Best: " << best->threads << " threads, GPU " << (best->use_gpu ? "on" : "off") << " ("
+              << static_cast<int>(best->ms) << " ms for " << clip_seconds << "s of audio)" << std::endl;
+    return 0;
+}
+
+} // namespace SuperWhisper
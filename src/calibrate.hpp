@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+namespace SuperWhisper {
+
+struct Settings;
+
+// --calibrate: transcribe a short clip (audio_path, or whisper.cpp's samples/jfk.wav when
+// empty) with the GPU backend on and off at several thread counts, then store the fastest
+// num_threads / use_gpu in `settings` and save them to config_path. Returns the exit code.
+int run_calibration(Settings& settings, const std::string& config_path, const std::string& audio_path);
+
+} // namespace SuperWhisper
@@ -0,0 +1,233 @@
+#include "cascade_wrapper.hpp"
+#include "settings.hpp"
+#include "metrics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+namespace SuperWhisper {
+
+class ModelCascade : public CascadeWrapper {
+public:
+    using WhisperWrapper::load_model;
+    using WhisperWrapper::transcribe;
+    using WhisperWrapper::transcribe_segments;
+    
+    explicit ModelCascade(const Settings& settings)
+        : draft_path_(settings.cascade_draft_model),
+          logprob_threshold_(settings.cascade_logprob_threshold),
+          entropy_threshold_(settings.cascade_entropy_threshold),
+          draft_(create_whisper_wrapper()),
+          verifier_(create_whisper_wrapper()) {}
+    
+    // `path` is the verifier. Both models load here - on the background loader thread when
+    // there is one - so the first low-confidence segment does not stall on a model load.
+    bool load_model(const std::string& path, const ModelLoadOptions& options) override {
+        unload_model();
+        
+        if (!draft_->load_model(draft_path_, options)) {
+            std::cerr << "Failed to load cascade draft model: " << draft_path_ << std::endl;
+            return false;
+        }
+        
+        // Without a verifier the cascade still transcribes - with the draft model alone
+        if (!verifier_->load_model(path, options)) {
+            std::cerr << "Cascade verifier unavailable, keeping draft results: " << path << std::endl;
+            return true;
+        }
+        
+        std::cout << "Model cascade: " << draft_path_ << " drafts, " << path
+                  << " re-decodes low-confidence segments" << std::endl;
+        return true;
+    }
+    
+    size_t reserve(size_t max_samples, int sample_rate) override {
+        return draft_->reserve(max_samples, sample_rate) +
+               (verifier_->is_loaded() ? verifier_->reserve(max_samples, sample_rate) : 0);
+    }
+    
+    const std::string& transcribe(const AudioView& audio, int sample_rate, const Settings& settings) override {
+        const TranscriptSegments segments = transcribe_segments(audio, sample_rate, settings);
+        for (const auto& segment : segments) {
+            commit_context(segment.text);  // A mix of both models' tokens - retokenized by each
+        }
+        format_transcript(segments, settings.output_format, output_);
+        return output_;
+    }
+    
+    TranscriptSegments transcribe_segments(const AudioView& audio, int sample_rate, const Settings& settings) override {
+        TranscriptSegments draft = draft_->transcribe_segments(audio, sample_rate, settings);
+        timings_ = draft_->last_timings();
+        
+        TranscriptSegments result;
+        result.reserve(draft.size());
+        size_t escalated = 0;
+        
+        for (size_t i = 0; i < draft.size();) {
+            if (!needs_escalation(draft[i])) {
+                result.push_back(std::move(draft[i++]));
+                continue;
+            }
+            
+            // Neighbouring low-confidence segments share one verifier pass: fewer calls, more context
+            size_t end = i + 1;
+            while (end < draft.size() && needs_escalation(draft[end])) ++end;
+            
+            if (redecode(audio, sample_rate, settings, draft[i].start_ms, draft[end - 1].end_ms, result)) {
+                escalated += end - i;
+            } else {
+                // Verifier unavailable or silent: the draft is still the best we have
+                std::move(draft.begin() + i, draft.begin() + end, std::back_inserter(result));
+            }
+            i = end;
+        }
+        
+        // Draft segments may still be replaced, so nothing is delivered before this point
+        if (segment_callback_) {
+            for (const auto& segment : result) segment_callback_(segment);
+        }
+        
+        ++stats_.utterances;
+        stats_.segments += draft.size();
+        stats_.escalated_segments += escalated;
+        if (escalated > 0) ++stats_.escalated_utterances;
+        metrics::add(metrics::Counter::Escalations, escalated);
+        
+        return result;
+    }
+    
+    bool is_loaded() const override {
+        return draft_->is_loaded();
+    }
+    
+    // Both models see the same carried context
+    void set_context_tokens(int max_tokens) override {
+        draft_->set_context_tokens(max_tokens);
+        verifier_->set_context_tokens(max_tokens);
+    }
+    
+    void commit_context(const std::string& text) override {
+        draft_->commit_context(text);
+        verifier_->commit_context(text);
+    }
+    
+    void reset_context() override {
+        draft_->reset_context();
+        verifier_->reset_context();
+    }
+    
+    void set_segment_callback(SegmentCallback callback) override {
+        segment_callback_ = std::move(callback);
+    }
+    
+    DecodeTimings last_timings() const override {
+        return timings_;
+    }
+    
+    void unload_model() override {
+        draft_->unload_model();
+        verifier_->unload_model();
+    }
+    
+    // Both models unless the verifier failed to load; RSS is the same process either way
+    MemoryStats memory_stats() const override {
+        MemoryStats stats = draft_->memory_stats();
+        if (!verifier_->is_loaded()) return stats;
+        
+        const MemoryStats verifier = verifier_->memory_stats();
+        stats.weights_bytes += verifier.weights_bytes;
+        stats.kv_cache_bytes += verifier.kv_cache_bytes;
+        stats.compute_bytes += verifier.compute_bytes;
+        stats.scratch_bytes += verifier.scratch_bytes;
+        stats.weights_gpu_bytes += verifier.weights_gpu_bytes;
+        stats.state_gpu_bytes += verifier.state_gpu_bytes;
+        stats.measured = stats.measured && verifier.measured;
+        return stats;
+    }
+    
+    CascadeStats stats() const override {
+        return stats_;
+    }
+    
+private:
+    // Same criteria whisper.cpp uses for its temperature fallback: low average log
+    // probability, or low token entropy (a repetition loop) on a long enough segment
+    bool needs_escalation(const TranscriptSegment& segment) const {
+        if (segment.token_count == 0) return false;
+        if (segment.avg_logprob < logprob_threshold_) return true;
+        return segment.token_count >= kMinEntropyTokens && segment.token_entropy < entropy_threshold_;
+    }
+    
+    // Decode [start_ms, end_ms] (plus some context) on the verifier, appending its segments
+    bool redecode(const AudioView& audio, int sample_rate, const Settings& settings,
+                  int64_t start_ms, int64_t end_ms, TranscriptSegments& out) {
+        const auto start = std::chrono::steady_clock::now();
+        const bool ready = verifier_->is_loaded();
+        
+        TranscriptSegments segments;
+        int64_t offset_ms = 0;
+        if (ready) {
+            const size_t pad = static_cast<size_t>(sample_rate) * kEscalationPadMs / 1000;
+            size_t first = static_cast<size_t>(std::max<int64_t>(start_ms, 0)) * sample_rate / 1000;
+            first -= std::min(first, pad);
+            const size_t last = static_cast<size_t>(std::max<int64_t>(end_ms, 0)) * sample_rate / 1000 + pad;
+            
+            const AudioView region = audio.subview(first, last - std::min(last, first));
+            offset_ms = static_cast<int64_t>(first) * 1000 / sample_rate;
+            if (!region.empty()) {
+                segments = verifier_->transcribe_segments(region, sample_rate, settings);
+            }
+            timings_.inference_ms += verifier_->last_timings().inference_ms;
+        }
+        
+        stats_.verifier_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        
+        // Segments centred in the padding belong to the draft's neighbours - dropping them avoids doubled words
+        bool replaced = false;
+        for (auto& segment : segments) {
+            segment.start_ms += offset_ms;
+            segment.end_ms += offset_ms;
+            const int64_t middle = (segment.start_ms + segment.end_ms) / 2;
+            if (middle >= start_ms && middle <= end_ms) {
+                out.push_back(std::move(segment));
+                replaced = true;
+            }
+        }
+        return replaced;
+    }
+    
+    // Context kept around an escalated region so words at its edges are not cut
+    static constexpr int kEscalationPadMs = 200;
+    
+    // Token entropy is meaningless on a handful of tokens
+    static constexpr int kMinEntropyTokens = 16;
+    
+    const std::string draft_path_;
+    const float logprob_threshold_;
+    const float entropy_threshold_;
+    
+    std::unique_ptr<WhisperWrapper> draft_;
+    std::unique_ptr<WhisperWrapper> verifier_;
+    
+    std::string output_;
+    SegmentCallback segment_callback_;
+    DecodeTimings timings_;
+    CascadeStats stats_;
+};
+
+void print_cascade_stats(const CascadeStats& stats) {
+    char line[160];
+    std::snprintf(line, sizeof(line), "Cascade: %zu/%zu segments re-decoded (%.1f%%), %zu/%zu utterances escalated, %.0f ms in verifier",
+                  stats.escalated_segments, stats.segments,
+                  stats.segments > 0 ? 100.0 * stats.escalated_segments / stats.segments : 0.0,
+                  stats.escalated_utterances, stats.utterances, stats.verifier_ms);
+    std::cout << line << std::endl;
+}
+
+// Factory function
+std::unique_ptr<CascadeWrapper> create_cascade_wrapper(const Settings& settings) {
+    return std::make_unique<ModelCascade>(settings);
+}
+
+} // namespace SuperWhisper
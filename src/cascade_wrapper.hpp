@@ -0,0 +1,34 @@
+#pragma once
+
+#include "whisper_wrapper.hpp"
+#include <memory>
+
+namespace SuperWhisper {
+
+struct Settings;
+
+// How much of the audio the verifier model had to redo
+struct CascadeStats {
+    size_t utterances = 0;
+    size_t escalated_utterances = 0;  // Utterances with at least one re-decoded segment
+    size_t segments = 0;              // Segments produced by the draft model
+    size_t escalated_segments = 0;    // ... of which were re-decoded by the verifier
+    double verifier_ms = 0.0;         // Time spent in the verifier
+};
+
+// Two-model cascade behind the WhisperWrapper interface. Everything is decoded
+// by a small draft model first; only segments whose confidence falls below the
+// cascade thresholds are re-decoded by the model passed to load_model(); both
+// models are loaded by load_model().
+class CascadeWrapper : public WhisperWrapper {
+public:
+    virtual CascadeStats stats() const = 0;
+};
+
+// Print running escalation counts ("Cascade: 3/40 segments re-decoded ...")
+void print_cascade_stats(const CascadeStats& stats);
+
+// Factory function - the draft model is settings.cascade_draft_model
+std::unique_ptr<CascadeWrapper> create_cascade_wrapper(const Settings& settings);
+
+} // namespace SuperWhisper
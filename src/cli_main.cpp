@@ -1,13 +1,31 @@
 #include "settings.hpp"
 #include "audio_recorder.hpp"
 #include "whisper_wrapper.hpp"
+#include "background_loader.hpp"
+#include "cascade_wrapper.hpp"
+#include "model_manager.hpp"
 #include "hotkey_manager.hpp"
+#include "streaming_transcriber.hpp"
+#include "audio_dsp.hpp"
+#include "vad.hpp"
+#include "daemon.hpp"
+#include "batch.hpp"
+#include "calibrate.hpp"
+#include "clipboard.hpp"
+#include "profiler.hpp"
+#include "metrics.hpp"
+#include "segment_sink.hpp"
+#include "event_loop.hpp"
 #include <iostream>
 #include <fstream>
 #include <chrono>
 #include <thread>
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <mutex>
+#include <optional>
+#include <vector>
 #include <signal.h>
 #include <unistd.h>
 #include <termios.h> // Required for termios
@@ -18,6 +36,17 @@ namespace SuperWhisper {
 // Global flag for graceful shutdown
 static std::atomic<bool> g_should_exit{false};
 
+// Main loop to wake on shutdown (set while run() or the daemon is active)
+static std::atomic<EventLoop*> g_event_loop{nullptr};
+
+// Request shutdown from any thread or signal handler
+void request_exit() {
+    g_should_exit = true;
+    if (EventLoop* loop = g_event_loop.load()) {
+        loop->notify();
+    }
+}
+
 // Global terminal settings for restoration
 static struct termios g_old_termios;
 static bool g_terminal_modified = false;
@@ -38,7 +67,7 @@ void signal_handler(int signal) {
         // Restore terminal settings if modified
         cleanup_terminal();
         
-        g_should_exit = true;
+        request_exit();
     }
 }
 
@@ -60,32 +89,65 @@ public:
     void save_config(const std::string& path);
     void load_config(const std::string& path);
     
+    // The background model load failed, or the model did not fit the memory budget
+    bool model_failed() const { return model_failed_; }
+    
 private:
+    bool on_model_loaded(bool loaded, WhisperWrapper& whisper);
+    
     // Core components
     std::unique_ptr<AudioRecorder> audio_recorder_;
-    std::unique_ptr<WhisperWrapper> whisper_wrapper_;
+    std::unique_ptr<BackgroundLoadWrapper> whisper_wrapper_;  // Loads the model while capture runs
+    CascadeWrapper* cascade_ = nullptr;  // The wrapped model when it is a cascade
     std::unique_ptr<HotkeyManager> hotkey_manager_;
+    std::unique_ptr<StreamingTranscriber> streaming_transcriber_;
+    std::unique_ptr<VoiceActivityDetector> vad_;
+    std::unique_ptr<Clipboard> clipboard_;
     
     // App state
     std::atomic<bool> is_recording_{false};
+    std::atomic<bool> model_failed_{false};
     Settings settings_;
     
     // Audio processing
     AudioBuffer audio_buffer_;
     std::mutex audio_mutex_;
     
-    // Voice activity detection
-    std::optional<std::chrono::steady_clock::time_point> last_voice_time_;
+    // Voice activity detection (written by the audio callback, read by the main loop)
+    std::atomic<EventLoop::Clock::rep> last_voice_time_{0};
+    EventLoop::Clock::time_point recording_start_time_;
+    EventLoop::Clock::time_point recording_stop_time_;
+    
+    // Pipeline stage (piped audio input): utterances are cut on the audio's own clock,
+    // transcripts go to stdout and everything else to stderr
+    bool pipeline_ = false;
+    std::ostream transcript_out_{nullptr};
+    size_t utterance_samples_ = 0;     // Audio thread only
+    size_t last_voice_sample_ = 0;
+    bool heard_voice_ = false;
+    
+    // Long-form output file, appended to as segments are committed (one recording at a time)
+    std::ofstream session_file_;
+    const SegmentSink* session_sink_ = nullptr;
+    std::string session_buffer_;
+    size_t session_segments_ = 0;
+    
+    // Main loop wakeups; hotkey threads post start/stop requests through it
+    EventLoop event_loop_;
+    std::atomic<bool> start_requested_{false};
+    std::atomic<bool> stop_requested_{false};
     
     // Worker threads
-    std::thread recording_thread_;
     std::thread transcription_thread_;
     
     // Internal methods
-    void recording_worker();
+    void handle_key(char key);
+    std::optional<EventLoop::Clock::time_point> next_deadline() const;
+    void check_deadlines();
     void transcription_worker();
     void process_audio_chunk(const AudioSample* data, size_t count);
     void handle_transcription_result(const std::string& text);
+    void next_utterance();
     void copy_to_clipboard(const std::string& text);
     void save_to_file(const std::string& text);
     
@@ -101,20 +163,54 @@ private:
 bool SuperWhisperCLI::initialize(const Settings& settings) {
     try {
         settings_ = settings;
+        apply_decode_preset(settings_, true);
         
         // Initialize audio recorder
-        audio_recorder_ = create_audio_recorder();
+        audio_recorder_ = create_audio_recorder(settings_);
         if (!audio_recorder_) {
             std::cerr << "Failed to create audio recorder" << std::endl;
             return false;
         }
         
-        // Initialize Whisper wrapper
-        whisper_wrapper_ = create_whisper_wrapper();
-        if (!whisper_wrapper_) {
+        // Piped audio: no keyboard (stdin may be the audio), hotkeys or clipboard
+        pipeline_ = !audio_recorder_->is_live();
+        if (pipeline_) {
+            settings_.enable_hotkeys = false;
+            settings_.enable_terminal_input = false;
+            settings_.copy_to_clipboard = false;
+            transcript_out_.rdbuf(std::cout.rdbuf());
+            std::cout.rdbuf(std::cerr.rdbuf());
+            
+            // End of input closes the utterance in progress
+            audio_recorder_->set_end_callback([this]() {
+                stop_requested_ = true;
+                event_loop_.notify();
+            });
+        }
+        
+        // Initialize Whisper wrapper (a draft/verifier cascade when a draft model is configured)
+        std::unique_ptr<WhisperWrapper> whisper;
+        if (!settings_.cascade_draft_model.empty()) {
+            auto cascade = create_cascade_wrapper(settings_);
+            cascade_ = cascade.get();
+            whisper = std::move(cascade);
+        } else {
+            whisper = create_whisper_wrapper();
+        }
+        if (!whisper) {
             std::cerr << "Failed to create Whisper wrapper" << std::endl;
             return false;
         }
+        whisper_wrapper_ = create_background_loader(std::move(whisper), settings_,
+            [this](bool loaded, WhisperWrapper& inner) { return on_model_loaded(loaded, inner); });
+        
+        // Clipboard backend, resolved once instead of per utterance
+        if (settings_.copy_to_clipboard) {
+            clipboard_ = create_clipboard();
+            if (!clipboard_) {
+                std::cout << "Warning: No clipboard available (install wl-clipboard, xclip or xsel)" << std::endl;
+            }
+        }
         
         // Initialize hotkey manager if enabled
         if (settings_.enable_hotkeys) {
@@ -147,19 +243,60 @@ bool SuperWhisperCLI::initialize(const Settings& settings) {
             }
         }
         
-        // Load Whisper model
-        if (!whisper_wrapper_->load_model(settings_.model_path)) {
-            std::cerr << "Failed to load Whisper model: " << settings_.model_path << std::endl;
-            return false;
+        // Load Whisper model in the background: recording can start right away, audio waits
+        // in the capture ring and the first transcription starts once the model is ready
+        whisper_wrapper_->load_model(settings_.model_path, model_load_options(settings_));
+        
+        // Streaming, speculative and long-form modes decode in the background while recording
+        if (settings_.streaming_mode || settings_.speculative_decode || settings_.long_form) {
+            streaming_transcriber_ = create_streaming_transcriber(*whisper_wrapper_, settings_);
+            
+            // Show text as it is committed, while the recording continues
+            streaming_transcriber_->set_segment_callback([this](const TranscriptSegment& segment) {
+                std::cout << "  > " << segment.text << std::endl;
+                if (session_file_.is_open()) {
+                    session_buffer_.clear();
+                    session_sink_->write(segment, session_segments_++, session_buffer_);
+                    session_file_ << session_buffer_ << std::flush;
+                }
+            });
+            streaming_transcriber_->set_producer_waits(pipeline_);
+            if (settings_.long_form) {
+                std::cout << "Long-form mode enabled (" << settings_.long_form_chunk_ms << "ms chunks, "
+                          << settings_.long_form_overlap_ms << "ms overlap, no duration limit)" << std::endl;
+            } else if (settings_.speculative_decode) {
+                std::cout << "Speculative decoding enabled (speech is decoded after "
+                          << settings_.speculative_pause_ms << "ms pauses)" << std::endl;
+            } else {
+                std::cout << "Streaming mode enabled (step " << settings_.stream_step_ms << "ms)" << std::endl;
+            }
         }
         
+        // Resolve DSP kernel dispatch now rather than on the first audio callback
+        std::cout << "DSP kernels: " << dsp::kernel_name() << std::endl;
+        
+        // Voice activity detection drives the silence auto-stop
+        vad_ = create_vad(settings_);
+        std::cout << "Voice activity detection: " << vad_->name() << std::endl;
+        
         // Set up audio callback for real-time processing
         audio_recorder_->set_audio_callback([this](const AudioSample* data, size_t count) {
             process_audio_chunk(data, count);
         });
         
+        // Keep the device open from here on (after the callback is set, since it runs at once):
+        // a start key only marks the ring, and the recording includes the audio just before it
+        if (settings_.always_armed && audio_recorder_->is_live()) {
+            if (audio_recorder_->arm()) {
+                std::cout << "Capture armed: recordings start instantly with " << settings_.preroll_ms
+                          << "ms pre-roll" << std::endl;
+            } else {
+                std::cout << "Warning: Failed to arm the capture stream, it is opened per recording" << std::endl;
+            }
+        }
+        
         std::cout << "SuperWhisper CLI initialized successfully" << std::endl;
-        std::cout << "Model loaded: " << settings_.model_path << std::endl;
+        std::cout << "Loading model: " << settings_.model_path << std::endl;
         std::cout << "Press Ctrl+C to exit" << std::endl;
         
         return true;
@@ -197,56 +334,44 @@ void SuperWhisperCLI::run() {
         terminal_mode_enabled = true;
     }
     
-    char input;
+    // A pipeline stage records from the start and keeps going until the input ends
+    if (pipeline_) {
+        start_requested_ = true;
+        event_loop_.notify();
+    }
+    
+    // Sleep until a key, a hotkey, a signal or the next recording deadline
+    int input_fd = settings_.enable_terminal_input ? STDIN_FILENO : -1;
+    g_event_loop = &event_loop_;
+    
     while (!g_should_exit) {
-        // Non-blocking input check (only if terminal input enabled)
-        if (settings_.enable_terminal_input && read(STDIN_FILENO, &input, 1) > 0) {
-            switch (input) {
-                case 'r':
-                case 'R':
-                    if (!is_recording_) {
-                        start_recording();
-                    }
-                    break;
-                    
-                case 's':
-                case 'S':
-                    if (is_recording_) {
-                        stop_recording();
-                    }
-                    break;
-                    
-                case 'q':
-                case 'Q':
-                    g_should_exit = true;
-                    break;
-                    
-                case '\n':
-                    // Ignore newline
-                    break;
-                    
-                default:
-                    if (is_recording_) {
-                        std::cout << "Recording... Press 's' to stop" << std::endl;
-                    } else if (settings_.enable_terminal_input) {
-                        std::cout << "Press 'r' to start recording, 's' to stop, 'q' to quit" << std::endl;
-                    }
-                    break;
+        if (event_loop_.wait(input_fd, next_deadline())) {
+            // One read per wakeup: with VMIN=0 a second read returns 0 when merely empty
+            char input[64];
+            const ssize_t count = read(STDIN_FILENO, input, sizeof(input));
+            for (ssize_t i = 0; i < count; ++i) {
+                handle_key(input[i]);
+            }
+            
+            // Readable but empty is end of input: stop watching, or poll() reports it forever
+            if (count == 0) {
+                input_fd = -1;
             }
         }
         
-        // Check for silence detection if recording
-        if (is_recording_) {
-            auto now = std::chrono::steady_clock::now();
-            if (last_voice_time_ && (now - *last_voice_time_) > std::chrono::duration<float>(settings_.silence_duration)) {
-                std::cout << "Silence detected, stopping recording..." << std::endl;
-                stop_recording();
-            }
+        // Hotkey requests run here so start/stop never race each other
+        if (start_requested_.exchange(false) && !is_recording_) {
+            start_recording();
+        }
+        if (stop_requested_.exchange(false) && is_recording_) {
+            stop_recording();
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(50)); // Reduced sleep for more responsive input
+        check_deadlines();
     }
     
+    g_event_loop = nullptr;
+    
     // Restore terminal settings if modified
     if (g_terminal_modified) {
         tcsetattr(STDIN_FILENO, TCSANOW, &g_old_termios);
@@ -254,19 +379,78 @@ void SuperWhisperCLI::run() {
     }
 }
 
+void SuperWhisperCLI::handle_key(char key) {
+    switch (key) {
+        case 'r':
+        case 'R':
+            if (!is_recording_) {
+                start_recording();
+            }
+            break;
+            
+        case 's':
+        case 'S':
+            if (is_recording_) {
+                stop_recording();
+            }
+            break;
+            
+        case 'q':
+        case 'Q':
+            g_should_exit = true;
+            break;
+            
+        case '\n':
+            // Ignore newline
+            break;
+            
+        default:
+            if (is_recording_) {
+                std::cout << "Recording... Press 's' to stop" << std::endl;
+            } else {
+                std::cout << "Press 'r' to start recording, 's' to stop, 'q' to quit" << std::endl;
+            }
+            break;
+    }
+}
+
+std::optional<EventLoop::Clock::time_point> SuperWhisperCLI::next_deadline() const {
+    if (!is_recording_ || pipeline_ || settings_.long_form) return std::nullopt;
+    
+    // Whichever comes first: the duration limit or the end of the silence window.
+    // Speech only moves the silence deadline later, so waking at a stale one just re-arms.
+    const auto max_end = recording_start_time_ + std::chrono::seconds(settings_.max_duration);
+    const auto last_voice = EventLoop::Clock::time_point(EventLoop::Clock::duration(last_voice_time_.load()));
+    const auto silence_end = last_voice + std::chrono::duration_cast<EventLoop::Clock::duration>(
+        std::chrono::duration<float>(settings_.silence_duration));
+    
+    return std::min(max_end, silence_end);
+}
+
+void SuperWhisperCLI::check_deadlines() {
+    if (!is_recording_ || pipeline_ || settings_.long_form) return;
+    
+    const auto now = EventLoop::Clock::now();
+    if (now >= recording_start_time_ + std::chrono::seconds(settings_.max_duration)) {
+        std::cout << "Maximum duration reached, stopping recording..." << std::endl;
+        stop_recording();
+    } else if (next_deadline() <= now) {
+        std::cout << "Silence detected, stopping recording..." << std::endl;
+        stop_recording();
+    }
+}
+
 void SuperWhisperCLI::shutdown() {
     // Stop recording
     stop_recording();
     
     // Wait for worker threads
-    if (recording_thread_.joinable()) {
-        recording_thread_.join();
-    }
     if (transcription_thread_.joinable()) {
         transcription_thread_.join();
     }
     
     // Cleanup components
+    if (streaming_transcriber_) streaming_transcriber_->cancel();
     if (audio_recorder_) audio_recorder_->stop();
     if (whisper_wrapper_) whisper_wrapper_->unload_model();
     if (hotkey_manager_) hotkey_manager_->shutdown();
@@ -278,6 +462,10 @@ void SuperWhisperCLI::shutdown() {
     }
     
     std::cout << "SuperWhisper CLI shutdown complete" << std::endl;
+    
+    if (pipeline_) {
+        std::cout.rdbuf(transcript_out_.rdbuf());
+    }
 }
 
 void SuperWhisperCLI::start_recording() {
@@ -285,9 +473,6 @@ void SuperWhisperCLI::start_recording() {
     
     try {
         // Ensure previous threads are cleaned up
-        if (recording_thread_.joinable()) {
-            recording_thread_.join();
-        }
         if (transcription_thread_.joinable()) {
             transcription_thread_.join();
         }
@@ -297,20 +482,45 @@ void SuperWhisperCLI::start_recording() {
             audio_recorder_->clear();
         }
         
+        if (vad_) {
+            vad_->reset();
+        }
+        
+        // The silence window starts now, so a recording with no speech still stops
+        recording_start_time_ = EventLoop::Clock::now();
+        last_voice_time_ = recording_start_time_.time_since_epoch().count();
+        utterance_samples_ = 0;
+        last_voice_sample_ = 0;
+        heard_voice_ = false;
+        
+        // A long session is written out as it goes rather than only at the end
+        if (settings_.long_form && !settings_.output_file.empty()) {
+            session_file_.open(settings_.output_file);
+            if (!session_file_.is_open()) {
+                std::cerr << "Failed to open output file: " << settings_.output_file << std::endl;
+            }
+            session_sink_ = &get_segment_sink(settings_.output_format);
+            session_buffer_.clear();
+            session_segments_ = 0;
+            session_sink_->begin(session_buffer_);
+            session_file_ << session_buffer_;
+        }
+        
+        // Begin background decoding before the first audio chunk arrives
+        if (streaming_transcriber_) {
+            streaming_transcriber_->start();
+        }
+        
+        // Set first: a piped source starts delivering from start() itself
+        is_recording_ = true;
         if (!audio_recorder_->start()) {
+            is_recording_ = false;
             handle_error("Failed to start recording");
             return;
         }
         
-        is_recording_ = true;
         std::cout << "Recording started... (Press 's' to stop)" << std::endl;
         
-        // Start recording worker thread
-        recording_thread_ = std::thread([this]() { recording_worker(); });
-        
-        // Reset voice detection
-        last_voice_time_ = std::chrono::steady_clock::now();
-        
     } catch (const std::exception& e) {
         handle_error("Recording start failed: " + std::string(e.what()));
     }
@@ -319,51 +529,75 @@ void SuperWhisperCLI::start_recording() {
 void SuperWhisperCLI::stop_recording() {
     if (!is_recording_) return;
     
+    // --profile timeline runs from here to the result being delivered
+    profiler::begin_utterance();
+    recording_stop_time_ = EventLoop::Clock::now();
+    
     is_recording_ = false;
     
     if (audio_recorder_) {
+        profiler::ScopedTimer timer("audio_recorder stop");
         audio_recorder_->stop();
-    }
-    
-    // Wait for recording thread to finish
-    if (recording_thread_.joinable()) {
-        recording_thread_.join();
+        
+        // Overflows are audio the device dropped because the callback fell behind
+        const CaptureStats capture = audio_recorder_->capture_stats();
+        metrics::add(metrics::Counter::CaptureOverflows, capture.overflows);
+        if (capture.overflows > 0) {
+            std::cout << "Warning: " << capture.overflows << " input overflow(s) while recording"
+                      << " - raise frames_per_buffer or input_latency_ms" << std::endl;
+        }
     }
     
     // Wait for any previous transcription thread to complete
     if (transcription_thread_.joinable()) {
+        profiler::ScopedTimer timer("join transcription_thread");
         transcription_thread_.join();
     }
     
-    // Check if we have audio to transcribe
-    if (audio_recorder_ && !audio_recorder_->get_audio().empty()) {
+    // Piped input is mostly silence between utterances - only speech is transcribed
+    if (pipeline_ && !heard_voice_) {
+        if (streaming_transcriber_) streaming_transcriber_->cancel();
+        next_utterance();
+        return;
+    }
+    
+    // Check if we have audio to transcribe (streaming mode always finishes its session)
+    if (streaming_transcriber_ || (audio_recorder_ && audio_recorder_->has_audio())) {
         std::cout << "Transcribing audio..." << std::endl;
         
         // Start transcription in separate thread
-        transcription_thread_ = std::thread([this]() { transcription_worker(); });
+        transcription_thread_ = std::thread([this]() {
+            transcription_worker();
+            if (pipeline_) next_utterance();
+        });
     } else {
         std::cout << "No audio recorded" << std::endl;
+        if (pipeline_) next_utterance();
     }
 }
 
-void SuperWhisperCLI::recording_worker() {
-    try {
-        auto start_time = std::chrono::steady_clock::now();
+// Loader thread: finishes setup on the freshly loaded model before anything else may use it
+bool SuperWhisperCLI::on_model_loaded(bool loaded, WhisperWrapper& whisper) {
+    if (!loaded) {
+        std::cerr << "Failed to load Whisper model: " << settings_.model_path << std::endl;
+    } else {
+        // Dictation is one session: each recording is prompted with the end of the last
+        whisper.set_context_tokens(settings_.context_tokens);
         
-        while (is_recording_) {
-            // Check duration limit
-            auto now = std::chrono::steady_clock::now();
-            if ((now - start_time) > std::chrono::seconds(settings_.max_duration)) {
-                std::cout << "Maximum duration reached, stopping recording..." << std::endl;
-                break;
-            }
-            
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        }
+        // One arena for the whole session: utterances up to max_duration never allocate in the wrapper
+        const size_t arena_bytes = whisper.reserve(
+            static_cast<size_t>(settings_.max_duration) * settings_.sample_rate, settings_.sample_rate);
+        std::cout << "Transcription buffers: " << arena_bytes / 1024 << " KB reserved for "
+                  << settings_.max_duration << "s utterances" << std::endl;
         
-    } catch (const std::exception& e) {
-        std::cerr << "Recording worker error: " << e.what() << std::endl;
+        loaded = check_memory_budget(whisper.memory_stats(), settings_.memory_budget_mb);
     }
+    
+    if (!loaded) {
+        model_failed_ = true;
+        request_exit();
+    }
+    return loaded;
 }
 
 void SuperWhisperCLI::transcription_worker() {
@@ -373,22 +607,68 @@ void SuperWhisperCLI::transcription_worker() {
             return;
         }
         
-        // Get recorded audio
-        AudioBuffer audio = audio_recorder_->get_audio();
-        if (audio.empty()) {
-            handle_error("No audio to transcribe");
+        // Audio recorded while the model was still loading is transcribed as soon as it is ready
+        if (!whisper_wrapper_->is_loaded()) {
+            std::cout << "Waiting for the model to finish loading..." << std::endl;
+        }
+        if (!whisper_wrapper_->wait_until_loaded()) {
+            handle_error("Model not available");
             return;
         }
         
-        // Transcribe audio
-        std::string text = whisper_wrapper_->transcribe(audio, settings_.sample_rate, settings_);
+        std::string streamed_text;
+        const std::string* text = &streamed_text;
+        
+        if (streaming_transcriber_) {
+            // Most segments are already committed - only the tail is decoded here
+            profiler::ScopedTimer timer("streaming finish");
+            streamed_text = format_transcript(streaming_transcriber_->finish(), settings_.output_format);
+            
+            if (session_file_.is_open()) {
+                session_buffer_.clear();
+                session_sink_->end(session_buffer_);
+                session_file_ << session_buffer_ << std::endl;
+                session_file_.close();
+                std::cout << "Text saved to: " << settings_.output_file << std::endl;
+            }
+        } else {
+            // Recording has stopped, so the capture ring can be read in place
+            AudioView audio = audio_recorder_->get_audio_view();
+            if (audio.empty()) {
+                handle_error("No audio to transcribe");
+                return;
+            }
+            
+            // Transcribe audio
+            profiler::ScopedTimer timer("transcribe");
+            const auto start = EventLoop::Clock::now();
+            // Text stays in the wrapper's reused output buffer until the next utterance
+            text = &whisper_wrapper_->transcribe(audio, audio_recorder_->sample_rate(), settings_);
+            
+            if (metrics::enabled()) {
+                const double audio_seconds = static_cast<double>(audio.size()) / audio_recorder_->sample_rate();
+                metrics::add(metrics::Counter::AudioMs, static_cast<uint64_t>(audio_seconds * 1000.0));
+                metrics::observe(metrics::Histogram::RealTimeFactor,
+                                 std::chrono::duration<double>(EventLoop::Clock::now() - start).count() / audio_seconds);
+                metrics::observe(metrics::Histogram::Memory, static_cast<double>(whisper_wrapper_->get_memory_usage()));
+            }
+        }
+        metrics::add(metrics::Counter::Utterances);
+        metrics::observe(metrics::Histogram::StopToText,
+                         std::chrono::duration<double>(EventLoop::Clock::now() - recording_stop_time_).count());
         
-        if (!text.empty()) {
-            handle_transcription_result(text);
+        if (!text->empty()) {
+            handle_transcription_result(*text);
         } else {
             handle_error("Transcription produced no text");
         }
         
+        if (cascade_) {
+            print_cascade_stats(cascade_->stats());
+        }
+        
+        profiler::print_utterance(std::cout);
+        
         // Clear audio buffer to free memory
         audio_recorder_->clear();
         
@@ -400,31 +680,65 @@ void SuperWhisperCLI::transcription_worker() {
 void SuperWhisperCLI::process_audio_chunk(const AudioSample* data, size_t count) {
     if (!is_recording_) return;
     
-    // Voice activity detection
-    float max_amplitude = 0.0f;
-    for (size_t i = 0; i < count; ++i) {
-        float amplitude = std::abs(static_cast<float>(data[i])) / 32768.0f;
-        max_amplitude = std::max(max_amplitude, amplitude);
+    // Feed the background decoder
+    if (streaming_transcriber_) {
+        streaming_transcriber_->push_audio(data, count);
+    }
+    
+    // Voice activity detection (runs on the audio thread)
+    // No wakeup needed: voice only pushes the main loop's silence deadline later
+    const bool voice = vad_ && vad_->process(data, count);
+    if (voice) {
+        last_voice_time_ = EventLoop::Clock::now().time_since_epoch().count();
     }
     
-    if (max_amplitude > settings_.silence_threshold) {
-        last_voice_time_ = std::chrono::steady_clock::now();
+    // Piped audio arrives faster than real time: the limits count samples instead
+    if (pipeline_) {
+        utterance_samples_ += count;
+        if (voice) {
+            last_voice_sample_ = utterance_samples_;
+            heard_voice_ = true;
+        }
+        
+        // A long-form session lasts until the input ends
+        if (settings_.long_form) return;
+        
+        const size_t rate = static_cast<size_t>(audio_recorder_->sample_rate());
+        const bool silent = utterance_samples_ - last_voice_sample_ >= static_cast<size_t>(settings_.silence_duration * rate);
+        const bool full = utterance_samples_ >= static_cast<size_t>(settings_.max_duration) * rate;
+        if (silent || full) {
+            // Nothing past this chunk belongs to the utterance
+            audio_recorder_->stop();
+            stop_requested_ = true;
+            event_loop_.notify();
+        }
     }
 }
 
 void SuperWhisperCLI::handle_transcription_result(const std::string& text) {
+    // Pipeline stage: one transcript per utterance, flushed for the next stage
+    if (pipeline_) {
+        transcript_out_ << text << std::endl;
+        return;
+    }
+    
     try {
-        std::cout << "\n=== Transcription Result ===" << std::endl;
-        std::cout << text << std::endl;
-        std::cout << "===========================" << std::endl;
+        {
+            profiler::ScopedTimer timer("print result");
+            std::cout << "\n=== Transcription Result ===" << std::endl;
+            std::cout << text << std::endl;
+            std::cout << "===========================" << std::endl;
+        }
         
-        // Save to file if specified
-        if (!settings_.output_file.empty()) {
+        // Save to file if specified (long-form sessions have written it already)
+        if (!settings_.output_file.empty() && !settings_.long_form) {
+            profiler::ScopedTimer timer("save_to_file");
             save_to_file(text);
         }
         
         // Copy to clipboard if enabled
         if (settings_.copy_to_clipboard) {
+            profiler::ScopedTimer timer("copy_to_clipboard");
             copy_to_clipboard(text);
         } else {
             std::cout << "Clipboard copying disabled in settings" << std::endl;
@@ -439,37 +753,32 @@ void SuperWhisperCLI::handle_transcription_result(const std::string& text) {
 }
 
 void SuperWhisperCLI::copy_to_clipboard(const std::string& text) {
-    // On macOS, use pbcopy to copy text to clipboard
-    // Use a temporary file approach for better reliability with special characters
+    if (!clipboard_) {
+        return;
+    }
     
-    try {
-        // Create a temporary file
-        std::string temp_file = "/tmp/superwhisper_clipboard_" + std::to_string(getpid()) + ".txt";
-        
-        // Write text to temporary file
-        std::ofstream temp_out(temp_file);
-        if (!temp_out.is_open()) {
-            std::cout << "Failed to create temporary file for clipboard" << std::endl;
-            return;
-        }
-        temp_out << text;
-        temp_out.close();
-        
-        // Copy from file to clipboard
-        std::string command = "cat '" + temp_file + "' | pbcopy";
-        int result = system(command.c_str());
-        
-        // Clean up temporary file
-        std::remove(temp_file.c_str());
-        
-        if (result == 0) {
-            std::cout << "Text copied to clipboard" << std::endl;
-        } else {
-            std::cout << "Failed to copy to clipboard (error code: " << result << ")" << std::endl;
+    if (!clipboard_->copy(text)) {
+        std::cout << "Failed to copy to clipboard (" << clipboard_->name() << ")" << std::endl;
+        return;
+    }
+    std::cout << "Text copied to clipboard" << std::endl;
+    
+    // Drop the text straight into the focused application
+    if (settings_.auto_paste) {
+        profiler::ScopedTimer timer("paste");
+        if (!clipboard_->paste()) {
+            std::cout << "Failed to paste into the focused application" << std::endl;
         }
-        
-    } catch (const std::exception& e) {
-        std::cout << "Failed to copy to clipboard: " << e.what() << std::endl;
+    }
+}
+
+// Pipeline stage: carry on with the next utterance until the input runs out
+void SuperWhisperCLI::next_utterance() {
+    if (audio_recorder_->at_end()) {
+        request_exit();
+    } else {
+        start_requested_ = true;
+        event_loop_.notify();
     }
 }
 
@@ -493,15 +802,31 @@ void SuperWhisperCLI::handle_error(const std::string& error) {
 }
 
 void SuperWhisperCLI::on_hotkey_start() {
-    start_recording();
+    start_requested_ = true;
+    event_loop_.notify();
 }
 
 void SuperWhisperCLI::on_hotkey_stop() {
-    stop_recording();
+    stop_requested_ = true;
+    event_loop_.notify();
 }
 
 void SuperWhisperCLI::on_hotkey_quit() {
-    g_should_exit = true;
+    request_exit();
+}
+
+// --memory: load the model as the interactive mode would and report where its memory goes
+int print_model_memory(const Settings& settings) {
+    auto wrapper = create_whisper_wrapper();
+    if (!wrapper->load_model(settings.model_path, model_load_options(settings))) {
+        return 1;
+    }
+    wrapper->reserve(static_cast<size_t>(settings.max_duration) * settings.sample_rate, settings.sample_rate);
+    
+    const MemoryStats stats = wrapper->memory_stats();
+    std::cout << "\n";
+    print_memory_stats(stats);
+    return check_memory_budget(stats, settings.memory_budget_mb) ? 0 : 1;
 }
 
 void SuperWhisperCLI::save_config(const std::string& path) {
@@ -529,7 +854,23 @@ int main(int argc, char* argv[]) {
         std::string model_path = "";
         bool show_help = false;
         bool show_settings = false;
+        bool show_memory = false;
+        bool list_devices = false;
+        bool calibrate = false;
+        std::string calibrate_audio = "";
         bool disable_clipboard = false;
+        bool disable_cache = false;
+        std::string audio_input = "";
+        bool daemon_mode = false;
+        bool client_mode = false;
+        std::string socket_path = "";
+        std::vector<std::string> client_args;
+        bool batch_mode = false;
+        bool models_mode = false;
+        std::vector<std::string> models_args;
+        bool profile = false;
+        std::string trace_file = "";
+        std::vector<std::string> batch_inputs;
         
         for (int i = 1; i < argc; ++i) {
             if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
@@ -544,6 +885,16 @@ int main(int argc, char* argv[]) {
                 }
             } else if (strcmp(argv[i], "--settings") == 0 || strcmp(argv[i], "-s") == 0) {
                 show_settings = true;
+            } else if (strcmp(argv[i], "--memory") == 0) {
+                show_memory = true;
+            } else if (strcmp(argv[i], "--list-devices") == 0) {
+                list_devices = true;
+            } else if (strcmp(argv[i], "--calibrate") == 0) {
+                calibrate = true;
+                // Optional clip to time, e.g. a recording of your own voice
+                if (i + 1 < argc && argv[i + 1][0] != '-') {
+                    calibrate_audio = argv[++i];
+                }
             } else if (strcmp(argv[i], "--help-settings") == 0) {
                 SuperWhisper::Settings settings;
                 settings.load(config_file);
@@ -554,6 +905,41 @@ int main(int argc, char* argv[]) {
                 return 0;
             } else if (strcmp(argv[i], "--no-clipboard") == 0) {
                 disable_clipboard = true;
+            } else if (strcmp(argv[i], "--no-cache") == 0) {
+                disable_cache = true;
+            } else if (strcmp(argv[i], "--stdin") == 0) {
+                audio_input = "-";
+            } else if (strcmp(argv[i], "--input") == 0) {
+                if (i + 1 < argc) {
+                    audio_input = argv[++i];
+                }
+            } else if (strcmp(argv[i], "--profile") == 0) {
+                profile = true;
+            } else if (strcmp(argv[i], "--profile-trace") == 0) {
+                if (i + 1 < argc) {
+                    trace_file = argv[++i];
+                }
+            } else if (strcmp(argv[i], "--daemon") == 0) {
+                daemon_mode = true;
+            } else if (strcmp(argv[i], "--socket") == 0) {
+                if (i + 1 < argc) {
+                    socket_path = argv[++i];
+                }
+            } else if (strcmp(argv[i], "--client") == 0) {
+                // Everything after --client is the client command
+                client_mode = true;
+                client_args.assign(argv + i + 1, argv + argc);
+                break;
+            } else if (strcmp(argv[i], "--models") == 0) {
+                // Everything after --models is the model manager command
+                models_mode = true;
+                models_args.assign(argv + i + 1, argv + argc);
+                break;
+            } else if (strcmp(argv[i], "--batch") == 0) {
+                // Everything after --batch is an input file or directory
+                batch_mode = true;
+                batch_inputs.assign(argv + i + 1, argv + argc);
+                break;
             }
         }
         
@@ -565,9 +951,28 @@ int main(int argc, char* argv[]) {
             std::cout << "  -c, --config FILE    Specify config file (default: ~/.superwhisper/config.json)\n";
             std::cout << "  -m, --model PATH     Override model path from config\n";
             std::cout << "  -s, --settings       Show current settings\n";
+            std::cout << "  --memory             Load the model and show weights, KV cache, compute buffer and RSS usage\n";
+            std::cout << "  --list-devices       List audio input devices for the input_device setting\n";
+            std::cout << "  --calibrate [FILE]   Time a short clip across thread counts and GPU on/off, save the fastest\n";
+            std::cout << "                       num_threads/use_gpu to the config (default clip: whisper.cpp's jfk.wav)\n";
             std::cout << "  --help-settings      Show all available settings with descriptions\n";
             std::cout << "  -v, --version        Show version information\n";
-            std::cout << "  --no-clipboard       Disable clipboard copying for testing\n\n";
+            std::cout << "  --no-clipboard       Disable clipboard copying for testing\n";
+            std::cout << "  --no-cache           Decode everything again instead of reusing cached transcripts\n";
+            std::cout << "  --stdin              Transcribe WAV or raw s16le audio piped to stdin, one line per utterance\n";
+            std::cout << "                       on stdout (e.g. ffmpeg -i URL -f wav -ac 1 - | superwhisper --stdin)\n";
+            std::cout << "  --input PATH         Same, reading a FIFO or a Unix socket\n";
+            std::cout << "  --profile            Print a per-stage timing breakdown after each transcription\n";
+            std::cout << "  --profile-trace FILE Also write all stages as Chrome trace JSON (Perfetto) on exit\n";
+            std::cout << "  --daemon             Keep the model loaded and serve requests on a Unix socket\n";
+            std::cout << "  --socket PATH        Override daemon socket path from config\n";
+            std::cout << "  --client CMD [ARGS]  Send a command to a running daemon:\n";
+            std::cout << "                         transcribe FILE [FORMAT], pcm RATE [FORMAT] (s16le on stdin),\n";
+            std::cout << "                         start, stop [FORMAT], status, ping, shutdown\n";
+            std::cout << "  --batch PATH...      Transcribe files/directories (WAV; FLAC, MP3, ... via ffmpeg),\n";
+            std::cout << "                       writing output_format results next to each input\n";
+            std::cout << "  --models [CMD]       Manage the models next to model_path: list, download NAME, verify [MODEL...],\n";
+            std::cout << "                         quantize MODEL q4_0|q5_0|q5_1|q8_0, bench [MODEL...], import BENCH.json\n\n";
             std::cout << "Interactive Commands:\n";
             std::cout << "  r                    Start recording\n";
             std::cout << "  s                    Stop recording\n";
@@ -577,21 +982,48 @@ int main(int argc, char* argv[]) {
             std::cout << "  F10                  Stop recording (default)\n";
             std::cout << "  F12                  Quit application (default)\n\n";
             std::cout << "Example:\n";
-            std::cout << "  superwhisper -c ~/myconfig.json -m /path/to/model.bin\n\n";
+            std::cout << "  superwhisper -c ~/myconfig.json -m /path/to/model.bin\n";
+            std::cout << "  superwhisper --daemon &  superwhisper --client transcribe meeting.wav srt\n\n";
             std::cout << "Note: Hotkeys require accessibility permissions on macOS.\n";
             std::cout << "      Go to System Preferences > Security & Privacy > Accessibility\n";
             std::cout << "      and add Terminal (or your terminal app) to the list.\n\n";
             return 0;
         }
         
-        // Load settings
+        // Load settings (the client and a pipeline stage keep stdout for the transcript)
         SuperWhisper::Settings settings;
-        settings.load(config_file);
+        settings.load(config_file, client_mode || !audio_input.empty());
+        
+        if (!audio_input.empty()) {
+            settings.audio_input = audio_input;
+        }
         
         // Override model path if specified
         if (!model_path.empty()) {
             settings.model_path = model_path;
         }
+        
+        // Override daemon socket if specified
+        if (!socket_path.empty()) {
+            settings.daemon_socket = socket_path;
+        }
+        
+        if (disable_cache) {
+            settings.result_cache = false;
+        }
+        
+        if (client_mode) {
+            return SuperWhisper::run_client(settings, client_args);
+        }
+        
+        if (models_mode) {
+            return SuperWhisper::run_models_command(settings, models_args);
+        }
+        
+        // model_size "auto" resolves to a benchmarked local model unless -m chose one
+        if (settings.model_size == "auto" && model_path.empty()) {
+            SuperWhisper::select_auto_model(settings, false);
+        }
 
         // Disable clipboard copying if specified
         if (disable_clipboard) {
@@ -599,23 +1031,64 @@ int main(int argc, char* argv[]) {
             std::cout << "Clipboard copying disabled by command line option." << std::endl;
         }
         
-        if (show_settings) {
-            settings.print_current_settings();
+        if (calibrate) {
+            return SuperWhisper::run_calibration(settings, config_file, calibrate_audio);
+        }
+        
+        if (list_devices) {
+            return SuperWhisper::print_input_devices() ? 0 : 1;
+        }
+        
+        if (show_settings || show_memory) {
+            if (show_settings) {
+                settings.print_current_settings();
+            }
+            if (show_memory) {
+                return SuperWhisper::print_model_memory(settings);
+            }
             return 0;
         }
         
-        // Create and run CLI application
-        SuperWhisper::SuperWhisperCLI app;
+        if (profile || !trace_file.empty()) {
+            SuperWhisper::profiler::enable(true);
+        }
         
-        if (!app.initialize(settings)) {
-            std::cerr << "Failed to initialize SuperWhisper CLI" << std::endl;
-            return 1;
+        // Prometheus endpoint for the whole run (daemon, batch or dictation session)
+        const auto metrics_server = SuperWhisper::create_metrics_server(settings);
+        
+        int exit_code = 0;
+        if (daemon_mode) {
+            // Signals wake the daemon's accept loop through request_exit()
+            SuperWhisper::EventLoop daemon_loop;
+            SuperWhisper::g_event_loop = &daemon_loop;
+            exit_code = SuperWhisper::run_daemon(settings, SuperWhisper::g_should_exit, daemon_loop);
+            SuperWhisper::g_event_loop = nullptr;
+        } else if (batch_mode) {
+            exit_code = SuperWhisper::run_batch(settings, batch_inputs);
+        } else {
+            // Create and run CLI application
+            SuperWhisper::SuperWhisperCLI app;
+            
+            if (!app.initialize(settings)) {
+                std::cerr << "Failed to initialize SuperWhisper CLI" << std::endl;
+                return 1;
+            }
+            
+            app.run();
+            app.shutdown();
+            if (app.model_failed()) exit_code = 1;
         }
         
-        app.run();
-        app.shutdown();
+        // Timeline of every profiled stage for chrome://tracing / Perfetto
+        if (!trace_file.empty()) {
+            if (SuperWhisper::profiler::write_chrome_trace(trace_file)) {
+                std::cout << "Profile trace written to: " << trace_file << std::endl;
+            } else {
+                std::cerr << "Failed to write profile trace: " << trace_file << std::endl;
+            }
+        }
         
-        return 0;
+        return exit_code;
         
     } catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << std::endl;
@@ -0,0 +1,185 @@
+#include "clipboard.hpp"
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef __APPLE__
+#include <ApplicationServices/ApplicationServices.h>
+#include <Carbon/Carbon.h>
+#else
+#include "posix_io.hpp"
+#include <unistd.h>
+#endif
+
+namespace SuperWhisper {
+
+#ifdef __APPLE__
+
+// In-process Pasteboard Manager (the C API behind NSPasteboard) - no fork, no temp file.
+// Paste posts a synthesized Cmd+V through Quartz event services.
+class PasteboardClipboard : public Clipboard {
+public:
+    PasteboardClipboard() {
+        if (PasteboardCreate(kPasteboardClipboard, &pasteboard_) != noErr) {
+            pasteboard_ = nullptr;
+        }
+    }
+
+    ~PasteboardClipboard() override {
+        if (pasteboard_) CFRelease(pasteboard_);
+    }
+
+    bool is_valid() const {
+        return pasteboard_ != nullptr;
+    }
+
+    bool copy(const std::string& text) override {
+        CFDataRef data = CFDataCreate(kCFAllocatorDefault, reinterpret_cast<const UInt8*>(text.data()),
+                                      static_cast<CFIndex>(text.size()));
+        if (!data) return false;
+
+        PasteboardClear(pasteboard_);
+        const OSStatus status = PasteboardPutItemFlavor(pasteboard_, reinterpret_cast<PasteboardItemID>(1),
+                                                        CFSTR("public.utf8-plain-text"), data, kPasteboardFlavorNoFlags);
+        CFRelease(data);
+        return status == noErr;
+    }
+
+    bool paste() override {
+        // Synthesized input is silently dropped without accessibility permission
+        if (!AXIsProcessTrusted()) {
+            std::cerr << "Paste needs accessibility permission (System Settings > Privacy & Security > Accessibility)"
+                      << std::endl;
+            return false;
+        }
+
+        CGEventSourceRef source = CGEventSourceCreate(kCGEventSourceStateCombinedSessionState);
+        CGEventRef down = CGEventCreateKeyboardEvent(source, kVK_ANSI_V, true);
+        CGEventRef up = CGEventCreateKeyboardEvent(source, kVK_ANSI_V, false);
+        const bool created = down && up;
+        if (created) {
+            CGEventSetFlags(down, kCGEventFlagMaskCommand);
+            CGEventSetFlags(up, kCGEventFlagMaskCommand);
+            CGEventPost(kCGAnnotatedSessionEventTap, down);
+            CGEventPost(kCGAnnotatedSessionEventTap, up);
+        }
+        if (down) CFRelease(down);
+        if (up) CFRelease(up);
+        if (source) CFRelease(source);
+        return created;
+    }
+
+    const char* name() const override {
+        return "pasteboard";
+    }
+
+private:
+    PasteboardRef pasteboard_ = nullptr;
+};
+
+#else
+
+// Absolute path of `program` on PATH, empty if it is not installed
+std::string find_on_path(const std::string& program) {
+    const char* path = std::getenv("PATH");
+    if (!path) return {};
+
+    const std::string dirs = path;
+    for (size_t start = 0; start <= dirs.size();) {
+        const size_t end = std::min(dirs.find(':', start), dirs.size());
+        const std::string candidate = dirs.substr(start, end - start) + "/" + program;
+        if (end > start && access(candidate.c_str(), X_OK) == 0) {
+            return candidate;
+        }
+        start = end + 1;
+    }
+    return {};
+}
+
+// Clipboard through the display server's own tool. wl-copy and xclip fork a helper
+// that keeps serving the selection after we hand over the text, so the spawned
+// process exits as soon as its stdin is consumed. Exec'd directly: no shell, no temp file.
+class HelperClipboard : public Clipboard {
+public:
+    HelperClipboard(std::vector<std::string> copy_command, std::vector<std::string> paste_command)
+        : copy_command_(std::move(copy_command)), paste_command_(std::move(paste_command)) {
+        // A helper that dies early must not take the CLI down with it
+        std::signal(SIGPIPE, SIG_IGN);
+    }
+
+    bool copy(const std::string& text) override {
+        return run(copy_command_, &text);
+    }
+
+    bool paste() override {
+        if (paste_command_.empty()) {
+            std::cerr << "Paste needs wtype (Wayland) or xdotool (X11)" << std::endl;
+            return false;
+        }
+        return run(paste_command_, nullptr);
+    }
+
+    const char* name() const override {
+        return copy_command_.front().c_str() + copy_command_.front().rfind('/') + 1;
+    }
+
+private:
+    // Spawn `command` with `input` (if any) on its stdin and wait for it to exit.
+    // The forked selection server lives on after we exit, so it gets no descriptor of ours
+    // besides stdin and stderr - not even our terminal on stdout.
+    static bool run(const std::vector<std::string>& command, const std::string* input) {
+        ProcessIo io;
+        io.input = input;
+        io.discard_output = true;
+        return run_process(command, io).ok();
+    }
+
+    const std::vector<std::string> copy_command_;
+    const std::vector<std::string> paste_command_;
+};
+
+#endif
+
+// Factory function
+std::unique_ptr<Clipboard> create_clipboard() {
+#ifdef __APPLE__
+    auto clipboard = std::make_unique<PasteboardClipboard>();
+    if (!clipboard->is_valid()) {
+        return nullptr;
+    }
+    return clipboard;
+#else
+    std::vector<std::string> copy;
+    std::vector<std::string> paste;
+
+    if (std::getenv("WAYLAND_DISPLAY")) {
+        if (const std::string tool = find_on_path("wl-copy"); !tool.empty()) {
+            copy = {tool};
+        }
+        if (const std::string tool = find_on_path("wtype"); !tool.empty()) {
+            paste = {tool, "-M", "ctrl", "-k", "v", "-m", "ctrl"};
+        }
+    }
+    if (copy.empty() && std::getenv("DISPLAY")) {
+        if (const std::string tool = find_on_path("xclip"); !tool.empty()) {
+            copy = {tool, "-selection", "clipboard"};
+        } else if (const std::string xsel = find_on_path("xsel"); !xsel.empty()) {
+            copy = {xsel, "--clipboard", "--input"};
+        }
+    }
+    if (paste.empty() && std::getenv("DISPLAY")) {
+        if (const std::string tool = find_on_path("xdotool"); !tool.empty()) {
+            paste = {tool, "key", "--clearmodifiers", "ctrl+v"};
+        }
+    }
+
+    if (copy.empty()) {
+        return nullptr;
+    }
+    return std::make_unique<HelperClipboard>(std::move(copy), std::move(paste));
+#endif
+}
+
+} // namespace SuperWhisper
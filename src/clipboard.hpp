@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace SuperWhisper {
+
+// System clipboard plus an optional paste into the focused application
+class Clipboard {
+public:
+    virtual ~Clipboard() = default;
+
+    // Replace the clipboard contents with `text` (UTF-8)
+    virtual bool copy(const std::string& text) = 0;
+
+    // Paste the clipboard into whatever application has keyboard focus (Cmd+V / Ctrl+V).
+    // Needs accessibility permission on macOS; false if it could not be delivered.
+    virtual bool paste() = 0;
+
+    virtual const char* name() const = 0;
+};
+
+// Factory function - the Pasteboard Manager in-process on macOS; elsewhere wl-copy
+// (Wayland), xclip or xsel (X11), looked up once here. nullptr if none is available.
+std::unique_ptr<Clipboard> create_clipboard();
+
+} // namespace SuperWhisper
@@ -0,0 +1,679 @@
+#include "daemon.hpp"
+#include "settings.hpp"
+#include "event_loop.hpp"
+#include "audio_file.hpp"
+#include "audio_recorder.hpp"
+#include "metrics.hpp"
+#include "posix_io.hpp"
+#include "result_cache.hpp"
+#include "whisper_pool.hpp"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <cerrno>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+namespace SuperWhisper {
+
+namespace {
+
+using json = nlohmann::json;
+
+// Request lines are small; anything longer is a protocol error
+constexpr size_t kMaxLineBytes = 64 * 1024;
+
+// Upper bound for a single PCM upload (~4.6 hours of 16 kHz mono)
+constexpr size_t kMaxPcmBytes = 512u * 1024 * 1024;
+
+// Blocking line/blob reader and writer over a connected socket
+class SocketStream {
+public:
+    explicit SocketStream(int fd) : fd_(fd) {}
+
+    bool read_line(std::string& line) {
+        while (true) {
+            const size_t newline = buffer_.find('\n');
+            if (newline != std::string::npos) {
+                line = buffer_.substr(0, newline);
+                buffer_.erase(0, newline + 1);
+                return true;
+            }
+            if (buffer_.size() > kMaxLineBytes || !fill()) {
+                return false;
+            }
+        }
+    }
+
+    bool read_exact(size_t count, std::string& out) {
+        out.clear();
+        out.reserve(count);
+
+        // Bytes already buffered after the header line come first
+        const size_t buffered = std::min(count, buffer_.size());
+        out.append(buffer_, 0, buffered);
+        buffer_.erase(0, buffered);
+
+        while (out.size() < count) {
+            char chunk[64 * 1024];
+            const ssize_t n = recv(fd_, chunk, std::min(sizeof(chunk), count - out.size()), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            out.append(chunk, static_cast<size_t>(n));
+        }
+        return true;
+    }
+
+    bool write_all(const char* data, size_t size) {
+        while (size > 0) {
+            const ssize_t n = send(fd_, data, size, 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool write_line(const std::string& line) {
+        return write_all(line.data(), line.size()) && write_all("\n", 1);
+    }
+
+private:
+    bool fill() {
+        char chunk[4096];
+        while (true) {
+            const ssize_t n = recv(fd_, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            buffer_.append(chunk, static_cast<size_t>(n));
+            return true;
+        }
+    }
+
+    int fd_;
+    std::string buffer_;
+};
+
+bool make_address(const std::string& path, sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Daemon socket path too long: " << path << std::endl;
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+int connect_socket(const std::string& path) {
+    sockaddr_un addr;
+    if (!make_address(path, addr)) return -1;
+
+    const int fd = socket_cloexec(AF_UNIX, SOCK_STREAM);
+    if (fd < 0) return -1;
+
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+json error_response(const std::string& message) {
+    return json{{"ok", false}, {"error", message}};
+}
+
+} // namespace
+
+// Serves one warm model to any number of local clients. Requests are accepted
+// concurrently and decoded on a WhisperPool of settings.pool_size contexts.
+class Daemon {
+public:
+    Daemon(const Settings& settings, const std::atomic<bool>& should_exit, EventLoop& wakeup)
+        : settings_(settings), should_exit_(should_exit), wakeup_(wakeup) {}
+
+    ~Daemon() {
+        shutdown();
+    }
+
+    bool initialize() {
+        pool_ = create_whisper_pool(settings_.pool_size);
+        if (!pool_ || !pool_->load_model(settings_.model_path, model_load_options(settings_))) {
+            std::cerr << "Failed to load Whisper model: " << settings_.model_path << std::endl;
+            return false;
+        }
+
+        const MemoryStats memory = pool_->memory_stats();
+        print_memory_stats(memory);
+        if (!check_memory_budget(memory, settings_.memory_budget_mb)) {
+            return false;
+        }
+        cache_ = create_result_cache(settings_);
+
+        return listen_on(expand_home(settings_.daemon_socket));
+    }
+
+    void run() {
+        std::cout << "SuperWhisper daemon listening on " << socket_path_ << std::endl;
+        std::cout << "Model loaded: " << settings_.model_path << std::endl;
+
+        // Sleeps until a client connects or something notifies the loop: a signal,
+        // the shutdown command, or a connection handler that has finished
+        while (!should_exit_ && !shutdown_requested_) {
+            reap_connections();
+            if (!wakeup_.wait(listen_fd_, std::nullopt)) continue;
+
+            const int client = accept_cloexec(listen_fd_);
+            if (client < 0) continue;
+
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+            open_fds_.insert(client);
+            auto& connection = connections_.emplace_back();
+            connection.thread = std::thread([this, client, &connection]() {
+                serve(client);
+                connection.done = true;
+                wakeup_.notify();  // Reaped by the accept loop
+            });
+        }
+    }
+
+    void shutdown() {
+        if (listen_fd_ >= 0) {
+            close(listen_fd_);
+            listen_fd_ = -1;
+            unlink(socket_path_.c_str());
+        }
+
+        // Wake up handlers blocked on idle clients, then wait for them
+        {
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+            for (int fd : open_fds_) {
+                ::shutdown(fd, SHUT_RDWR);
+            }
+        }
+        for (auto& connection : connections_) {
+            if (connection.thread.joinable()) connection.thread.join();
+        }
+        connections_.clear();
+
+        std::lock_guard<std::mutex> lock(recorder_mutex_);
+        if (recorder_) recorder_->stop();
+        recorder_.reset();
+        if (pool_) pool_->unload_model();
+    }
+
+private:
+    struct Connection {
+        std::thread thread;
+        std::atomic<bool> done{false};
+    };
+
+    bool listen_on(const std::string& path) {
+        socket_path_ = path;
+        sockaddr_un addr;
+        if (!make_address(path, addr)) return false;
+
+        // Owner-only from the moment they exist: the directory we create and the socket bind()
+        // creates would otherwise get the process umask until the chmod below, and anyone who
+        // connects can open the microphone and read files
+        const mode_t old_umask = umask(077);
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+        // A socket file left behind by a crashed daemon is removed; a live one is not
+        if (std::filesystem::exists(path)) {
+            const int existing = connect_socket(path);
+            if (existing >= 0) {
+                close(existing);
+                umask(old_umask);
+                std::cerr << "Another daemon is already listening on " << path << std::endl;
+                return false;
+            }
+            unlink(path.c_str());
+        }
+
+        listen_fd_ = socket_cloexec(AF_UNIX, SOCK_STREAM);
+        const bool bound = listen_fd_ >= 0 && bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+        umask(old_umask);
+        if (!bound || listen(listen_fd_, 16) != 0) {
+            std::cerr << "Failed to listen on " << path << ": " << std::strerror(errno) << std::endl;
+            if (listen_fd_ >= 0) close(listen_fd_);
+            listen_fd_ = -1;
+            return false;
+        }
+
+        // Only the owning user may talk to the daemon (it can open the microphone)
+        chmod(path.c_str(), S_IRUSR | S_IWUSR);
+        return true;
+    }
+
+    void reap_connections() {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        for (auto it = connections_.begin(); it != connections_.end();) {
+            if (it->done) {
+                it->thread.join();
+                it = connections_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void serve(int fd) {
+        SocketStream stream(fd);
+        std::string line;
+
+        while (!shutdown_requested_ && stream.read_line(line)) {
+            if (line.empty()) continue;
+
+            json response;
+            try {
+                response = handle(json::parse(line), stream);
+            } catch (const json::exception& e) {
+                response = error_response(std::string("bad request: ") + e.what());
+            } catch (const std::exception& e) {
+                response = error_response(e.what());
+            }
+
+            // Replace rather than throw on a character whisper split across segments
+            if (!stream.write_line(response.dump(-1, ' ', false, json::error_handler_t::replace))) break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(connections_mutex_);
+            open_fds_.erase(fd);
+        }
+        close(fd);
+    }
+
+    json handle(const json& request, SocketStream& stream) {
+        const std::string cmd = request.value("cmd", "");
+        const std::string format = request.value("format", settings_.output_format);
+
+        if (cmd == "ping") {
+            return json{{"ok", true}};
+        }
+
+        if (cmd == "status") {
+            const MemoryStats memory = pool_->memory_stats();
+            std::lock_guard<std::mutex> lock(recorder_mutex_);
+            const CaptureStats capture = recorder_ ? recorder_->capture_stats() : CaptureStats{};
+            return json{{"ok", true},
+                        {"model", settings_.model_path},
+                        {"loaded", pool_->is_loaded()},
+                        {"pool_size", pool_->size()},
+                        {"pending", pool_->pending()},
+                        {"recording", recorder_ && recorder_->is_recording()},
+                        {"requests", requests_served_.load()},
+                        {"memory", {{"weights_bytes", memory.weights_bytes},
+                                    {"kv_cache_bytes", memory.kv_cache_bytes},
+                                    {"compute_bytes", memory.compute_bytes},
+                                    {"scratch_bytes", memory.scratch_bytes},
+                                    {"gpu_bytes", memory.gpu_bytes()},
+                                    {"rss_bytes", memory.rss_bytes},
+                                    {"peak_rss_bytes", memory.peak_rss_bytes},
+                                    {"measured", memory.measured}}},
+                        {"capture", {{"device", capture.device},
+                                     {"device_rate", capture.device_rate},
+                                     {"frames_per_buffer", capture.frames_per_buffer},
+                                     {"input_latency_ms", capture.input_latency_ms},
+                                     {"overflows", capture.overflows}}},
+                        {"cache", cache_json()}};
+        }
+
+        if (cmd == "shutdown") {
+            shutdown_requested_ = true;  // The loop wakes once this handler has replied
+            return json{{"ok", true}};
+        }
+
+        if (cmd == "transcribe_file") {
+            AudioFile audio;
+            std::string error;
+            if (!read_audio_file(request.value("path", ""), audio, error)) {
+                return error_response(error);
+            }
+            return transcribe(std::move(audio.samples), audio.sample_rate, format);
+        }
+
+        if (cmd == "transcribe_pcm") {
+            const int sample_rate = request.value("sample_rate", settings_.sample_rate);
+            const size_t bytes = request.value("bytes", size_t{0});
+            if (bytes > kMaxPcmBytes || bytes % sizeof(AudioSample) != 0 || sample_rate <= 0) {
+                return error_response("invalid PCM upload size or sample rate");
+            }
+
+            std::string payload;
+            if (!stream.read_exact(bytes, payload)) {
+                return error_response("connection closed during PCM upload");
+            }
+
+            // s16le on the wire; every supported host is little-endian
+            AudioBuffer samples(bytes / sizeof(AudioSample));
+            std::memcpy(samples.data(), payload.data(), bytes);
+            return transcribe(std::move(samples), sample_rate, format);
+        }
+
+        if (cmd == "transcribe_stream") {
+            return transcribe_stream(request.value("sample_rate", settings_.sample_rate), format, stream);
+        }
+
+        if (cmd == "start") {
+            std::lock_guard<std::mutex> lock(recorder_mutex_);
+            if (!recorder_) {
+                recorder_ = create_audio_recorder(settings_);
+                if (!recorder_) {
+                    return error_response("failed to create audio recorder");
+                }
+                // Later captures start without reopening the device, with their pre-roll
+                if (settings_.always_armed) recorder_->arm();
+            }
+            if (recorder_->is_recording()) {
+                return error_response("already recording");
+            }
+            recorder_->clear();
+            if (!recorder_->start()) {
+                return error_response("failed to start recording");
+            }
+            return json{{"ok", true}};
+        }
+
+        if (cmd == "stop") {
+            std::unique_lock<std::mutex> lock(recorder_mutex_);
+            if (!recorder_ || !recorder_->is_recording()) {
+                return error_response("not recording");
+            }
+            recorder_->stop();
+            metrics::add(metrics::Counter::CaptureOverflows, recorder_->capture_stats().overflows);
+
+            // Copy out of the ring so the next capture can start while this one decodes
+            AudioBuffer samples = recorder_->get_audio();
+            const int sample_rate = recorder_->sample_rate();
+            recorder_->clear();
+            lock.unlock();
+            return transcribe(std::move(samples), sample_rate, format, true);
+        }
+
+        return error_response("unknown command: " + cmd);
+    }
+
+    // live: a capture from start/stop - decoded with the interactive preset and never cached,
+    // since it cannot repeat
+    json transcribe(AudioBuffer audio, int sample_rate, const std::string& format, bool live = false) {
+        if (audio.empty()) {
+            return error_response("no audio to transcribe");
+        }
+
+        const int64_t audio_ms = static_cast<int64_t>(audio.size()) * 1000 / sample_rate;
+        const auto start = std::chrono::steady_clock::now();
+
+        // Timed formats keep timestamps under the interactive preset
+        Settings settings = settings_;
+        settings.output_format = format;
+        apply_decode_preset(settings, live);
+
+        // The same audio with the same settings decodes to the same segments
+        TranscriptSegments segments;
+        std::string key;
+        bool cached = false;
+        if (cache_ && !live) {
+            key = result_cache_key(AudioView{audio, {}, 0}, sample_rate, settings);
+            cached = cache_->lookup(key, segments);
+        }
+        if (!cached) {
+            segments = pool_->submit(std::move(audio), sample_rate, settings).get();
+            if (!key.empty()) cache_->store(key, segments);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;  // Includes time queued
+        ++requests_served_;
+        metrics::add(metrics::Counter::Utterances);
+        metrics::add(metrics::Counter::AudioMs, static_cast<uint64_t>(audio_ms));
+        if (live) {
+            metrics::observe(metrics::Histogram::StopToText, std::chrono::duration<double>(elapsed).count());
+        }
+
+        return json{{"ok", true},
+                    {"text", format_transcript(segments, format)},
+                    {"audio_ms", audio_ms},
+                    {"cached", cached},
+                    {"elapsed_ms", std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()}};
+    }
+
+    // Audio of any length, decoded long-form while it is uploaded: whenever a long_form_chunk_ms
+    // piece is complete it is decoded, segments ending in its last long_form_overlap_ms are
+    // dropped and the next piece starts where the last kept one ends. Only about one piece is
+    // held, and reading stalls while it decodes, so a fast sender is throttled by the socket.
+    json transcribe_stream(int sample_rate, const std::string& format, SocketStream& stream) {
+        if (sample_rate <= 0) {
+            return error_response("invalid sample rate");
+        }
+
+        Settings settings = settings_;
+        settings.output_format = format;
+        apply_decode_preset(settings, false);
+
+        const size_t chunk = std::max<size_t>(1, static_cast<size_t>(std::max(settings_.long_form_chunk_ms, 1000)) * sample_rate / 1000);
+        const size_t overlap = std::min(static_cast<size_t>(std::max(settings_.long_form_overlap_ms, 0)) * sample_rate / 1000, chunk / 2);
+        const auto to_ms = [sample_rate](uint64_t samples) { return static_cast<int64_t>(samples * 1000 / sample_rate); };
+
+        const auto start = std::chrono::steady_clock::now();
+        AudioBuffer pending;
+        uint64_t pending_start = 0;  // Stream position of pending[0], in samples
+        uint64_t total = 0;
+        TranscriptSegments result;
+        std::string line;
+        std::string payload;
+        bool done = false;
+
+        while (!done) {
+            if (!stream.read_line(line)) {
+                return error_response("connection closed during PCM stream");
+            }
+            size_t bytes = 0;
+            try {
+                bytes = std::stoul(line);
+            } catch (const std::exception&) {
+                return error_response("bad PCM stream chunk header: " + line);
+            }
+            if (bytes > kMaxPcmBytes || bytes % sizeof(AudioSample) != 0) {
+                return error_response("invalid PCM stream chunk size");
+            }
+            done = bytes == 0;
+            if (!done) {
+                if (!stream.read_exact(bytes, payload)) {
+                    return error_response("connection closed during PCM stream");
+                }
+                // s16le on the wire; every supported host is little-endian
+                const size_t old_size = pending.size();
+                pending.resize(old_size + bytes / sizeof(AudioSample));
+                std::memcpy(pending.data() + old_size, payload.data(), bytes);
+                total += bytes / sizeof(AudioSample);
+            }
+
+            while (pending.size() >= chunk || (done && !pending.empty())) {
+                const size_t count = std::min(chunk, pending.size());
+                const bool last = done && count == pending.size();
+                TranscriptSegments segments =
+                    pool_->submit(AudioBuffer(pending.begin(), pending.begin() + count), sample_rate, settings).get();
+
+                // The last piece keeps everything; others keep what ends before the overlap
+                size_t kept = segments.size();
+                size_t consumed = count;
+                if (!last) {
+                    const int64_t keep_end_ms = to_ms(count - overlap);
+                    kept = 0;
+                    while (kept < segments.size() && segments[kept].end_ms <= keep_end_ms) ++kept;
+                    if (kept == 0 && !segments.empty()) kept = 1;  // Runs into the overlap: keep it rather than stall
+                    consumed = kept > 0 ? std::min(count, static_cast<size_t>(segments[kept - 1].end_ms * sample_rate / 1000))
+                                        : count - overlap;
+                    if (consumed == 0) consumed = count - overlap;
+                }
+
+                const int64_t offset_ms = to_ms(pending_start);
+                for (size_t i = 0; i < kept; ++i) {
+                    segments[i].start_ms += offset_ms;
+                    segments[i].end_ms += offset_ms;
+                    result.push_back(std::move(segments[i]));
+                }
+                pending.erase(pending.begin(), pending.begin() + consumed);
+                pending_start += consumed;
+            }
+        }
+
+        if (total == 0) {
+            return error_response("no audio to transcribe");
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        ++requests_served_;
+        metrics::add(metrics::Counter::Utterances);
+        metrics::add(metrics::Counter::AudioMs, static_cast<uint64_t>(to_ms(total)));
+
+        return json{{"ok", true},
+                    {"text", format_transcript(result, format)},
+                    {"audio_ms", to_ms(total)},
+                    {"cached", false},
+                    {"elapsed_ms", std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()}};
+    }
+
+    json cache_json() const {
+        if (!cache_) {
+            return json{{"enabled", false}};
+        }
+        const ResultCacheStats stats = cache_->stats();
+        return json{{"enabled", true},
+                    {"hits", stats.hits},
+                    {"misses", stats.misses},
+                    {"evictions", stats.evictions},
+                    {"entries", stats.entries},
+                    {"bytes", stats.bytes},
+                    {"hit_rate", stats.hit_rate()}};
+    }
+
+    Settings settings_;
+    const std::atomic<bool>& should_exit_;
+    EventLoop& wakeup_;
+    std::atomic<bool> shutdown_requested_{false};
+    std::atomic<uint64_t> requests_served_{0};
+
+    std::unique_ptr<WhisperPool> pool_;
+    std::unique_ptr<ResultCache> cache_;  // nullptr when result_cache is off
+
+    std::unique_ptr<AudioRecorder> recorder_;
+    std::mutex recorder_mutex_;
+
+    int listen_fd_ = -1;
+    std::string socket_path_;
+
+    std::list<Connection> connections_;  // std::list keeps Connection addresses stable
+    std::set<int> open_fds_;
+    std::mutex connections_mutex_;
+};
+
+int run_daemon(const Settings& settings, const std::atomic<bool>& should_exit, EventLoop& wakeup) {
+    // A client hanging up mid-response must not kill the daemon
+    signal(SIGPIPE, SIG_IGN);
+
+    Daemon daemon(settings, should_exit, wakeup);
+    if (!daemon.initialize()) {
+        return 1;
+    }
+
+    daemon.run();
+    daemon.shutdown();
+    std::cout << "SuperWhisper daemon stopped" << std::endl;
+    return 0;
+}
+
+int run_client(const Settings& settings, const std::vector<std::string>& args) {
+    if (args.empty()) {
+        std::cerr << "Usage: --client transcribe FILE [FORMAT] | pcm RATE [FORMAT] | start | stop [FORMAT] | status | ping | shutdown" << std::endl;
+        return 1;
+    }
+
+    const std::string& command = args[0];
+    json request;
+    bool stream_stdin = false;  // pcm: stdin is sent in chunks as it is read
+    size_t format_arg = 1;
+
+    if (command == "transcribe") {
+        if (args.size() < 2) {
+            std::cerr << "Usage: --client transcribe FILE [FORMAT]" << std::endl;
+            return 1;
+        }
+        // The daemon runs in a different working directory
+        request = {{"cmd", "transcribe_file"}, {"path", std::filesystem::absolute(args[1]).string()}};
+        format_arg = 2;
+    } else if (command == "pcm") {
+        if (args.size() < 2) {
+            std::cerr << "Usage: --client pcm RATE [FORMAT] < audio.s16le" << std::endl;
+            return 1;
+        }
+        request = {{"cmd", "transcribe_stream"}, {"sample_rate", std::stoi(args[1])}};
+        stream_stdin = true;
+        format_arg = 2;
+    } else if (command == "start" || command == "stop" || command == "status" ||
+               command == "ping" || command == "shutdown") {
+        request = {{"cmd", command}};
+    } else {
+        std::cerr << "Unknown client command: " << command << std::endl;
+        return 1;
+    }
+
+    if (args.size() > format_arg) {
+        request["format"] = args[format_arg];
+    }
+
+    const std::string path = expand_home(settings.daemon_socket);
+    const int fd = connect_socket(path);
+    if (fd < 0) {
+        std::cerr << "Cannot connect to daemon at " << path << " (start it with --daemon)" << std::endl;
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    SocketStream stream(fd);
+    std::string line;
+    bool sent = stream.write_line(request.dump());
+    if (sent && stream_stdin) {
+        char chunk[64 * 1024];
+        while (sent && std::cin.read(chunk, sizeof(chunk)).gcount() > 0) {
+            // Whole samples per chunk; a trailing odd byte is dropped
+            const size_t count = static_cast<size_t>(std::cin.gcount()) & ~(sizeof(AudioSample) - 1);
+            if (count == 0) continue;
+            sent = stream.write_line(std::to_string(count)) && stream.write_all(chunk, count);
+        }
+        sent = sent && stream.write_line("0");
+    }
+    const bool received = sent && stream.read_line(line);
+    close(fd);
+
+    if (!received) {
+        std::cerr << "Daemon closed the connection" << std::endl;
+        return 1;
+    }
+
+    const json response = json::parse(line, nullptr, false);
+    if (response.is_discarded() || !response.value("ok", false)) {
+        std::cerr << "Error: " << (response.is_discarded() ? line : response.value("error", "unknown error")) << std::endl;
+        return 1;
+    }
+
+    if (response.contains("text")) {
+        std::cout << response["text"].get<std::string>() << std::endl;
+    } else if (command == "status") {
+        std::cout << response.dump(2) << std::endl;
+    }
+
+    return 0;
+}
+
+} // namespace SuperWhisper
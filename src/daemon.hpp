@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace SuperWhisper {
+
+struct Settings;
+class EventLoop;
+
+// Persistent daemon: loads the model once and serves requests over a Unix
+// domain socket (settings.daemon_socket) until a shutdown request arrives or
+// should_exit is set. Whoever sets should_exit notifies `wakeup` (the accept loop
+// sleeps on it). Returns the process exit code.
+//
+// Protocol - one JSON object per line in, one JSON line back per request:
+//   {"cmd":"transcribe_file","path":"/abs/file.wav","format":"srt"}
+//   {"cmd":"transcribe_pcm","sample_rate":16000,"bytes":N}  followed by N bytes of s16le mono
+//   {"cmd":"transcribe_stream","sample_rate":16000}          followed by chunks of s16le mono, each
+//                                                            a line with its byte count and the bytes;
+//                                                            a "0" line ends the stream. Decoded in
+//                                                            long_form_chunk_ms pieces as it arrives
+//   {"cmd":"start"} / {"cmd":"stop"}                         microphone capture, stop returns the transcript
+//   {"cmd":"status"} / {"cmd":"ping"} / {"cmd":"shutdown"}
+// Responses are {"ok":true,"text":...} or {"ok":false,"error":"..."}.
+// "format" is optional everywhere and defaults to settings.output_format.
+int run_daemon(const Settings& settings, const std::atomic<bool>& should_exit, EventLoop& wakeup);
+
+// Thin client: send one command (the words after --client) and print the result
+//   transcribe FILE [FORMAT] | pcm RATE [FORMAT] (PCM streamed from stdin) | start | stop [FORMAT] | status | ping | shutdown
+int run_client(const Settings& settings, const std::vector<std::string>& args);
+
+} // namespace SuperWhisper
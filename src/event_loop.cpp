@@ -0,0 +1,68 @@
+#include "event_loop.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace SuperWhisper {
+
+EventLoop::EventLoop() {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        std::cerr << "Failed to create event loop pipe: " << std::strerror(errno) << std::endl;
+        return;
+    }
+    
+    // Non-blocking on both ends: notify() never stalls, draining never blocks
+    for (int fd : fds) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    wake_read_ = fds[0];
+    wake_write_ = fds[1];
+}
+
+EventLoop::~EventLoop() {
+    if (wake_read_ >= 0) close(wake_read_);
+    if (wake_write_ >= 0) close(wake_write_);
+}
+
+void EventLoop::notify() {
+    if (wake_write_ < 0) return;
+    
+    // A full pipe (EAGAIN) already guarantees a pending wakeup
+    const char byte = 1;
+    ssize_t result;
+    do {
+        result = write(wake_write_, &byte, 1);
+    } while (result < 0 && errno == EINTR);
+}
+
+bool EventLoop::wait(int input_fd, std::optional<Clock::time_point> deadline) {
+    pollfd fds[2] = {
+        {wake_read_, POLLIN, 0},
+        {input_fd, POLLIN, 0},  // poll() ignores negative descriptors
+    };
+    
+    int timeout_ms = -1;
+    if (deadline) {
+        const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(*deadline - Clock::now());
+        timeout_ms = static_cast<int>(std::max<std::chrono::milliseconds::rep>(0, remaining.count()));
+    }
+    
+    if (poll(fds, 2, timeout_ms) <= 0) {
+        return false;  // Deadline reached or interrupted by a signal
+    }
+    
+    if (fds[0].revents & POLLIN) {
+        char buffer[64];
+        while (read(wake_read_, buffer, sizeof(buffer)) > 0) {}
+    }
+    
+    return input_fd >= 0 && (fds[1].revents & (POLLIN | POLLHUP));
+}
+
+} // namespace SuperWhisper
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+
+namespace SuperWhisper {
+
+// Sleep-until-something-happens primitive for the main thread: a poll() over
+// one input descriptor and a self-pipe, with an optional deadline as the timer.
+// Other threads (audio callback, hotkeys) and signal handlers call notify() to
+// wake it, so the process does no periodic wakeups while idle.
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    EventLoop();
+    ~EventLoop();
+    
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+    
+    bool is_valid() const { return wake_read_ >= 0; }
+    
+    // Wake the waiting thread. Lock-free and async-signal-safe; wakeups coalesce.
+    void notify();
+    
+    // Block until input_fd is readable (-1 to not watch any), notify() is called,
+    // or the deadline passes. Returns true if input_fd is readable.
+    bool wait(int input_fd, std::optional<Clock::time_point> deadline);
+    
+private:
+    int wake_read_ = -1;
+    int wake_write_ = -1;
+};
+
+} // namespace SuperWhisper
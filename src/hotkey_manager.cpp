@@ -32,6 +32,17 @@ public:
             std::cout << "and add Terminal (or your terminal app) to the list." << std::endl;
         }
         
+        // One handler for every hotkey; the hotkey's id says which was pressed
+        EventTypeSpec event_type;
+        event_type.eventClass = kEventClassKeyboard;
+        event_type.eventKind = kEventHotKeyPressed;
+        
+        OSStatus status = InstallEventHandler(GetApplicationEventTarget(), hotkey_handler, 1, &event_type, this, &handler_ref_);
+        if (status != noErr) {
+            std::cerr << "Failed to install event handler: " << status << std::endl;
+            return false;
+        }
+        
         is_initialized_ = true;
         return true;
     }
@@ -40,6 +51,10 @@ public:
         if (!is_initialized_) return;
         
         unregister_all_hotkeys();
+        if (handler_ref_) {
+            RemoveEventHandler(handler_ref_);
+            handler_ref_ = nullptr;
+        }
         is_initialized_ = false;
     }
     
@@ -47,21 +62,21 @@ public:
         if (!is_initialized_) return false;
         
         start_callback_ = callback;
-        return register_carbon_hotkey(key, start_hotkey_id_);
+        return register_carbon_hotkey(key, kStartId, start_hotkey_id_);
     }
     
     bool register_stop_hotkey(const std::string& key, std::function<void()> callback) override {
         if (!is_initialized_) return false;
         
         stop_callback_ = callback;
-        return register_carbon_hotkey(key, stop_hotkey_id_);
+        return register_carbon_hotkey(key, kStopId, stop_hotkey_id_);
     }
     
     bool register_quit_hotkey(const std::string& key, std::function<void()> callback) override {
         if (!is_initialized_) return false;
         
         quit_callback_ = callback;
-        return register_carbon_hotkey(key, quit_hotkey_id_);
+        return register_carbon_hotkey(key, kQuitId, quit_hotkey_id_);
     }
     
     void unregister_all_hotkeys() override {
@@ -89,7 +104,12 @@ private:
         return AXIsProcessTrusted();
     }
     
-    bool register_carbon_hotkey(const std::string& key, EventHotKeyRef& hotkey_ref) {
+    // Carbon reports hotkeys by these ids
+    static constexpr UInt32 kStartId = 1;
+    static constexpr UInt32 kStopId = 2;
+    static constexpr UInt32 kQuitId = 3;
+    
+    bool register_carbon_hotkey(const std::string& key, UInt32 id, EventHotKeyRef& hotkey_ref) {
         // Parse key string (e.g., "F9", "F10", "F12")
         UInt32 key_code = 0;
         UInt32 modifiers = 0;
@@ -109,23 +129,12 @@ private:
             return false;
         }
         
-        // Install event handler
-        EventTypeSpec event_type;
-        event_type.eventClass = kEventClassKeyboard;
-        event_type.eventKind = kEventHotKeyPressed;
-        
-        OSStatus status = InstallEventHandler(target, hotkey_handler, 1, &event_type, this, nullptr);
-        if (status != noErr) {
-            std::cerr << "Failed to install event handler: " << status << std::endl;
-            return false;
-        }
-        
         // Register hotkey
         EventHotKeyID hotkey_id;
         hotkey_id.signature = 'htk1';
-        hotkey_id.id = 1;
+        hotkey_id.id = id;
         
-        status = RegisterEventHotKey(key_code, modifiers, hotkey_id, target, 0, &hotkey_ref);
+        OSStatus status = RegisterEventHotKey(key_code, modifiers, hotkey_id, target, 0, &hotkey_ref);
         if (status != noErr) {
             std::cerr << "Failed to register hotkey: " << status << std::endl;
             return false;
@@ -141,16 +150,20 @@ private:
         EventHotKeyID hotkey_id;
         GetEventParameter(event, kEventParamDirectObject, typeEventHotKeyID, nullptr, sizeof(hotkey_id), nullptr, &hotkey_id);
         
-        // Determine which hotkey was pressed and call appropriate callback
-        if (hotkey_id.id == 1) {
-            if (manager->start_callback_) manager->start_callback_();
+        // The callbacks only set flags for the main loop, so nothing blocks the event thread
+        const std::function<void()>* callback = nullptr;
+        switch (hotkey_id.id) {
+            case kStartId: callback = &manager->start_callback_; break;
+            case kStopId: callback = &manager->stop_callback_; break;
+            case kQuitId: callback = &manager->quit_callback_; break;
         }
-        // Add more hotkey handling as needed
+        if (callback && *callback) (*callback)();
         
         return noErr;
     }
     
     bool is_initialized_;
+    EventHandlerRef handler_ref_ = nullptr;
     EventHotKeyRef start_hotkey_id_ = 0;
     EventHotKeyRef stop_hotkey_id_ = 0;
     EventHotKeyRef quit_hotkey_id_ = 0;
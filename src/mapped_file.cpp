@@ -0,0 +1,61 @@
+#include "mapped_file.hpp"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SuperWhisper {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        std::cerr << "Cannot map " << path << ": empty or unreadable file" << std::endl;
+        ::close(fd);
+        return false;
+    }
+    
+    // The mapping keeps its own reference to the file, the descriptor is not needed after this
+    void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "Cannot map " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    
+    data_ = data;
+    size_ = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) {
+        munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+void MappedFile::advise_sequential() const {
+    if (!data_) return;
+    
+    // Advisory only - a kernel that ignores it just reads on demand
+    madvise(data_, size_, MADV_SEQUENTIAL);
+    madvise(data_, size_, MADV_WILLNEED);
+}
+
+} // namespace SuperWhisper
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace SuperWhisper {
+
+// Read-only memory mapping of a whole file. Pages come straight from the
+// kernel page cache, so every process mapping the same file shares them.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    // Map `path`; prints the reason and returns false on failure
+    bool open(const std::string& path);
+    void close();
+    
+    // Tell the kernel the mapping will be read front to back, and start read-ahead now
+    void advise_sequential() const;
+    
+    const unsigned char* data() const { return static_cast<const unsigned char*>(data_); }
+    size_t size() const { return size_; }
+    bool is_open() const { return data_ != nullptr; }
+    
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace SuperWhisper
@@ -0,0 +1,351 @@
+#include "metrics.hpp"
+#include "settings.hpp"
+#include "event_loop.hpp"
+#include "posix_io.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace SuperWhisper {
+namespace metrics {
+
+namespace {
+
+constexpr size_t kCounters = static_cast<size_t>(Counter::Count);
+constexpr size_t kHistograms = static_cast<size_t>(Histogram::Count);
+constexpr size_t kMaxBounds = 10;
+constexpr double kMiB = 1024.0 * 1024.0;
+
+struct CounterInfo {
+    const char* name;
+    const char* help;
+    double scale;  // Stored unit -> exported unit
+};
+
+const CounterInfo kCounterInfo[kCounters] = {
+    {"superwhisper_utterances_total", "Transcriptions completed, cached or decoded", 1.0},
+    {"superwhisper_audio_seconds_total", "Seconds of audio transcribed", 0.001},
+    {"superwhisper_capture_overflows_total", "Capture input overflows (audio lost before the callback ran)", 1.0},
+    {"superwhisper_cache_hits_total", "Result cache hits", 1.0},
+    {"superwhisper_cache_misses_total", "Result cache misses", 1.0},
+    {"superwhisper_cascade_escalations_total", "Segments re-decoded by the cascade verifier", 1.0},
+};
+
+struct HistogramInfo {
+    const char* name;
+    const char* help;
+    size_t bound_count;
+    double bounds[kMaxBounds];  // Bucket upper bounds, ascending; +Inf is implied
+};
+
+const HistogramInfo kHistogramInfo[kHistograms] = {
+    {"superwhisper_stop_to_text_seconds", "Time from the end of a live recording to its transcript",
+     9, {0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30}},
+    {"superwhisper_real_time_factor", "Decode time divided by audio duration",
+     9, {0.05, 0.1, 0.2, 0.3, 0.5, 0.75, 1, 1.5, 2}},
+    {"superwhisper_queue_wait_seconds", "Time a pool job waited for a free decode context",
+     8, {0.001, 0.01, 0.05, 0.1, 0.25, 0.5, 1, 5}},
+    {"superwhisper_memory_bytes", "Model memory (weights, KV caches, compute buffers) after a decode",
+     8, {64 * kMiB, 128 * kMiB, 256 * kMiB, 512 * kMiB, 1024 * kMiB, 2048 * kMiB, 4096 * kMiB, 8192 * kMiB}},
+};
+
+// Written by its owning thread only; atomic so a concurrent scrape never reads a torn value
+struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, kCounters> counters{};
+    std::array<std::array<std::atomic<uint64_t>, kMaxBounds + 1>, kHistograms> buckets{};
+    std::array<std::atomic<double>, kHistograms> sums{};
+};
+
+// Shards summed for a scrape
+struct Totals {
+    std::array<uint64_t, kCounters> counters{};
+    std::array<std::array<uint64_t, kMaxBounds + 1>, kHistograms> buckets{};
+    std::array<double, kHistograms> sums{};
+
+    void add(const Shard& shard) {
+        for (size_t c = 0; c < kCounters; ++c) {
+            counters[c] += shard.counters[c].load(std::memory_order_relaxed);
+        }
+        for (size_t h = 0; h < kHistograms; ++h) {
+            for (size_t b = 0; b <= kMaxBounds; ++b) {
+                buckets[h][b] += shard.buckets[h][b].load(std::memory_order_relaxed);
+            }
+            sums[h] += shard.sums[h].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+std::atomic<bool> g_enabled{false};
+std::mutex g_mutex;            // Guards the shard list, never taken on the update path
+std::vector<Shard*> g_shards;  // One per thread that has recorded something
+Totals g_retired;              // Shards of threads that have exited
+
+// Registers the thread's shard on first use and folds it into g_retired at thread exit
+struct ShardHandle {
+    Shard* shard = new Shard;
+
+    ShardHandle() {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_shards.push_back(shard);
+    }
+
+    ~ShardHandle() {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_retired.add(*shard);
+        g_shards.erase(std::find(g_shards.begin(), g_shards.end(), shard));
+        delete shard;
+    }
+};
+
+Shard& local_shard() {
+    thread_local ShardHandle handle;
+    return *handle.shard;
+}
+
+// Single writer: a plain load and store instead of a locked read-modify-write
+template <typename T>
+void bump(std::atomic<T>& value, T delta) {
+    value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+void append(std::string& out, const char* format, double value) {
+    char number[32];
+    std::snprintf(number, sizeof(number), format, value);
+    out += number;
+}
+
+void append_header(std::string& out, const char* name, const char* help, const char* type) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+} // namespace
+
+void enable(bool on) {
+    g_enabled = on;
+}
+
+bool enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void add(Counter counter, uint64_t value) {
+    if (!enabled()) return;
+    bump(local_shard().counters[static_cast<size_t>(counter)], value);
+}
+
+void observe(Histogram histogram, double value) {
+    if (!enabled()) return;
+    const size_t h = static_cast<size_t>(histogram);
+    const HistogramInfo& info = kHistogramInfo[h];
+
+    // First bucket whose upper bound is >= value; past the last bound is +Inf
+    const size_t bucket = std::lower_bound(info.bounds, info.bounds + info.bound_count, value) - info.bounds;
+    Shard& shard = local_shard();
+    bump(shard.buckets[h][bucket], uint64_t{1});
+    bump(shard.sums[h], value);
+}
+
+void write_prometheus(std::string& out) {
+    Totals totals;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        totals = g_retired;
+        for (const Shard* shard : g_shards) {
+            totals.add(*shard);
+        }
+    }
+
+    for (size_t c = 0; c < kCounters; ++c) {
+        const CounterInfo& info = kCounterInfo[c];
+        append_header(out, info.name, info.help, "counter");
+        out += info.name;
+        out += ' ';
+        append(out, "%.15g", static_cast<double>(totals.counters[c]) * info.scale);
+        out += '\n';
+    }
+
+    // Buckets are kept per bucket and exported cumulatively, as Prometheus expects
+    for (size_t h = 0; h < kHistograms; ++h) {
+        const HistogramInfo& info = kHistogramInfo[h];
+        append_header(out, info.name, info.help, "histogram");
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b <= info.bound_count; ++b) {
+            cumulative += totals.buckets[h][b];
+            out += info.name;
+            out += "_bucket{le=\"";
+            if (b < info.bound_count) {
+                append(out, "%.15g", info.bounds[b]);
+            } else {
+                out += "+Inf";
+            }
+            out += "\"} ";
+            out += std::to_string(cumulative);
+            out += '\n';
+        }
+        out += info.name;
+        out += "_sum ";
+        append(out, "%.15g", totals.sums[h]);
+        out += '\n';
+        out += info.name;
+        out += "_count ";
+        out += std::to_string(cumulative);
+        out += '\n';
+    }
+}
+
+} // namespace metrics
+
+namespace {
+
+// Scrape requests are a few hundred bytes; anything longer is not one
+constexpr size_t kMaxRequestBytes = 8 * 1024;
+
+// A scraper hanging up mid-response must not raise SIGPIPE in the host process.
+// Linux takes a send() flag; macOS has no MSG_NOSIGNAL and sets SO_NOSIGPIPE instead.
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+class HttpMetricsServer : public MetricsServer {
+public:
+    ~HttpMetricsServer() override {
+        stopping_ = true;
+        event_loop_.notify();
+        if (thread_.joinable()) thread_.join();
+        if (listen_fd_ >= 0) close(listen_fd_);
+    }
+
+    bool listen_on(const std::string& address, int port) {
+        if (!event_loop_.is_valid()) {
+            return false;  // Without its wakeup pipe the server thread could never be stopped
+        }
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+            std::cerr << "Invalid metrics_address: " << address << std::endl;
+            return false;
+        }
+
+        listen_fd_ = socket_cloexec(AF_INET, SOCK_STREAM);
+        const int reuse = 1;
+        if (listen_fd_ < 0 ||
+            setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+            bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            listen(listen_fd_, 8) != 0) {
+            std::cerr << "Failed to serve metrics on " << address << ":" << port << ": "
+                      << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        thread_ = std::thread([this]() { run(); });
+        std::cout << "Metrics: http://" << address << ":" << port << "/metrics" << std::endl;
+        return true;
+    }
+
+private:
+    void run() {
+        // Sleeps until a scraper connects or the destructor wakes the loop
+        while (!stopping_) {
+            if (!event_loop_.wait(listen_fd_, std::nullopt)) continue;
+
+            const int client = accept_cloexec(listen_fd_);
+            if (client < 0) continue;
+            serve(client);
+            close(client);
+        }
+    }
+
+    // One request per connection; a stalled scraper is dropped after a second
+    void serve(int fd) {
+        const timeval timeout{1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+        const int no_sigpipe = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+
+        std::string request;
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < kMaxRequestBytes) {
+            char chunk[1024];
+            const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            request.append(chunk, static_cast<size_t>(n));
+        }
+
+        const std::string target = request.substr(0, request.find_first_of("? ", 4));
+        body_.clear();
+        const char* status = "404 Not Found";
+        if (target == "GET /metrics") {
+            status = "200 OK";
+            metrics::write_prometheus(body_);
+        } else {
+            body_ = "Not found - metrics are served at /metrics\n";
+        }
+
+        std::string response = std::string("HTTP/1.1 ") + status + "\r\n" +
+                               "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n" +
+                               "Content-Length: " + std::to_string(body_.size()) + "\r\n" +
+                               "Connection: close\r\n\r\n";
+        response += body_;
+
+        const char* data = response.data();
+        size_t size = response.size();
+        while (size > 0) {
+            const ssize_t n = send(fd, data, size, kSendFlags);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return;
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+    }
+
+    int listen_fd_ = -1;
+    std::atomic<bool> stopping_{false};
+    EventLoop event_loop_;
+    std::thread thread_;
+    std::string body_;  // Reused between scrapes
+};
+
+} // namespace
+
+// Factory function
+std::unique_ptr<MetricsServer> create_metrics_server(const Settings& settings) {
+    if (settings.metrics_port <= 0) {
+        return nullptr;
+    }
+
+    auto server = std::make_unique<HttpMetricsServer>();
+    if (!server->listen_on(settings.metrics_address, settings.metrics_port)) {
+        return nullptr;
+    }
+    metrics::enable(true);
+    return server;
+}
+
+} // namespace SuperWhisper
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace SuperWhisper {
+
+struct Settings;
+
+namespace metrics {
+
+// Process-wide counters and histograms for fleet monitoring (metrics_port). Every thread
+// updates a shard of its own with plain relaxed stores - no locks, no shared cache lines -
+// and a scrape adds the shards up. Everything is a no-op until enable(true).
+enum class Counter {
+    Utterances,        // Transcriptions completed, cached or decoded
+    AudioMs,           // Audio transcribed, exported in seconds
+    CaptureOverflows,  // Input overflows reported by the capture stream
+    CacheHits,
+    CacheMisses,
+    Escalations,       // Segments the cascade re-decoded with the verifier
+    Count
+};
+
+enum class Histogram {
+    StopToText,      // Seconds from the end of a live recording to its transcript
+    RealTimeFactor,  // Decode time / audio duration
+    QueueWait,       // Seconds a pool job waited for a free context
+    Memory,          // Bytes used by the model after a decode
+    Count
+};
+
+void enable(bool on);
+bool enabled();
+
+void add(Counter counter, uint64_t value = 1);
+void observe(Histogram histogram, double value);
+
+// Every metric in the Prometheus text exposition format, appended to `out`
+void write_prometheus(std::string& out);
+
+} // namespace metrics
+
+// Serves GET /metrics over HTTP on metrics_address:metrics_port until destroyed
+class MetricsServer {
+public:
+    virtual ~MetricsServer() = default;
+};
+
+// Factory function - enables the registry; nullptr when metrics_port is 0 or the port is unavailable
+std::unique_ptr<MetricsServer> create_metrics_server(const Settings& settings);
+
+} // namespace SuperWhisper
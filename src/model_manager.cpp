@@ -0,0 +1,716 @@
+#include "model_manager.hpp"
+#include "settings.hpp"
+#include "audio_file.hpp"
+#include "system_info.hpp"
+#include "posix_io.hpp"
+#include "whisper_wrapper.hpp"
+#include "ggml.h"
+#include "common-ggml.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <regex>
+
+namespace SuperWhisper {
+
+using json = nlohmann::json;
+
+namespace {
+
+// The repository download_fast_model.sh fetches from; "raw" serves each file's Git LFS
+// pointer, which carries the SHA-256 and size of the real file
+constexpr const char* kDownloadUrl = "https://huggingface.co/ggerganov/whisper.cpp/resolve/main/";
+constexpr const char* kPointerUrl = "https://huggingface.co/ggerganov/whisper.cpp/raw/main/";
+
+constexpr const char* kManifestName = "models.json";
+constexpr const char* kBenchClip = "external/whisper.cpp/samples/jfk.wav";
+constexpr int kBenchSeconds = 10;  // model_latency_target_ms is a budget for this much audio
+constexpr int kBenchRuns = 3;      // Median of this many decodes, after a warm-up
+
+// Matches the tensors whisper.cpp's quantize example leaves in full precision
+const std::vector<std::string> kQuantizeSkip = {
+    "encoder.conv1.bias",
+    "encoder.conv2.bias",
+    "encoder.positional_embedding",
+    "decoder.positional_embedding",
+};
+
+class Sha256 {
+public:
+    void update(const uint8_t* data, size_t size) {
+        length_ += size;
+        while (size > 0) {
+            const size_t n = std::min(size, block_.size() - used_);
+            std::memcpy(block_.data() + used_, data, n);
+            used_ += n;
+            data += n;
+            size -= n;
+            if (used_ == block_.size()) {
+                compress();
+                used_ = 0;
+            }
+        }
+    }
+
+    std::string hex() {
+        const uint64_t bits = length_ * 8;
+        const uint8_t pad = 0x80;
+        update(&pad, 1);
+        const uint8_t zero = 0;
+        while (used_ != 56) update(&zero, 1);
+        for (int i = 7; i >= 0; --i) {
+            const uint8_t byte = static_cast<uint8_t>(bits >> (i * 8));
+            update(&byte, 1);
+        }
+
+        char out[65];
+        for (int i = 0; i < 8; ++i) std::snprintf(out + i * 8, 9, "%08x", state_[i]);
+        return out;
+    }
+
+private:
+    static uint32_t rotr(uint32_t x, int r) {
+        return (x >> r) | (x << (32 - r));
+    }
+
+    void compress() {
+        static constexpr uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+        };
+
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (static_cast<uint32_t>(block_[i * 4]) << 24) | (static_cast<uint32_t>(block_[i * 4 + 1]) << 16) |
+                   (static_cast<uint32_t>(block_[i * 4 + 2]) << 8) | block_[i * 4 + 3];
+        }
+        for (int i = 16; i < 64; ++i) {
+            const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+        uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+        for (int i = 0; i < 64; ++i) {
+            const uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+            const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state_[0] += a; state_[1] += b; state_[2] += c; state_[3] += d;
+        state_[4] += e; state_[5] += f; state_[6] += g; state_[7] += h;
+    }
+
+    uint32_t state_[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    std::array<uint8_t, 64> block_{};
+    size_t used_ = 0;
+    uint64_t length_ = 0;
+};
+
+// "" if the file cannot be read
+std::string file_sha256(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return "";
+
+    Sha256 sha;
+    std::vector<char> buffer(1 << 20);
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+        sha.update(reinterpret_cast<const uint8_t*>(buffer.data()), static_cast<size_t>(file.gcount()));
+    }
+    return sha.hex();
+}
+
+// Run curl with `args`; with `body` set, its stdout is captured there instead of inherited
+bool run_curl(const std::vector<std::string>& args, std::string* body) {
+    std::vector<std::string> argv = {"curl"};
+    argv.insert(argv.end(), args.begin(), args.end());
+
+    ProcessIo io;
+    io.output = body;
+    const ProcessResult result = run_process(argv, io);
+    if (!result.started) {
+        std::cerr << "curl is not available" << std::endl;
+    }
+    return result.ok();
+}
+
+// SHA-256 and size published for an upstream file; false if it is not in the repository
+bool fetch_upstream_checksum(const std::string& file, std::string& sha256, uint64_t& size) {
+    std::string pointer;
+    if (!run_curl({"-fsSL", std::string(kPointerUrl) + file}, &pointer)) return false;
+
+    std::smatch oid, bytes;
+    if (!std::regex_search(pointer, oid, std::regex("oid sha256:([0-9a-f]{64})")) ||
+        !std::regex_search(pointer, bytes, std::regex("size ([0-9]+)"))) {
+        return false;
+    }
+    sha256 = oid[1];
+    size = std::stoull(bytes[1]);
+    return true;
+}
+
+// "base.en", "ggml-base.en.bin" and paths all name the same model
+std::string model_file_name(const std::string& name) {
+    std::string file = std::filesystem::path(name).filename().string();
+    if (file.rfind("ggml-", 0) != 0) file = "ggml-" + file;
+    if (std::filesystem::path(file).extension() != ".bin") file += ".bin";
+    return file;
+}
+
+// "ggml-small.en-q5_1.bin" -> "q5_1"; "" for full-precision models
+std::string quantization_of(const std::string& file) {
+    std::smatch match;
+    const std::string stem = std::filesystem::path(file).stem().string();
+    return std::regex_search(stem, match, std::regex("-(q[0-9]_[0-9k])$")) ? match[1].str() : "";
+}
+
+// Higher is more accurate: the model family first, then how much precision quantization kept
+int accuracy_rank(const std::string& file) {
+    static const char* families[] = {"ggml-tiny", "ggml-base", "ggml-small", "ggml-medium", "ggml-large"};
+    int family = 0;
+    for (int i = 0; i < 5; ++i) {
+        if (file.rfind(families[i], 0) == 0) family = i;
+    }
+
+    static const char* precisions[] = {"q4_0", "q4_1", "q5_0", "q5_1", "q8_0", ""};
+    const std::string quant = quantization_of(file);
+    int precision = 0;
+    for (int i = 0; i < 6; ++i) {
+        if (quant == precisions[i]) precision = i;
+    }
+    return family * 10 + precision;
+}
+
+std::string host_name() {
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0 || name[0] == '\0') return "localhost";
+    return name;
+}
+
+// Checksums and per-host measurements of the models in one directory
+class Manifest {
+public:
+    explicit Manifest(std::filesystem::path dir) : path_(std::move(dir) / kManifestName) {
+        std::ifstream file(path_);
+        if (!file.is_open()) return;
+        try {
+            data_ = json::parse(file);
+        } catch (const std::exception& e) {
+            std::cerr << "Ignoring unreadable " << path_.string() << ": " << e.what() << std::endl;
+        }
+    }
+
+    json& entry(const std::string& file) {
+        return data_["models"][file];
+    }
+
+    const json* find(const std::string& file) const {
+        if (!data_.contains("models") || !data_["models"].contains(file)) return nullptr;
+        return &data_["models"][file];
+    }
+
+    // Measurements taken on this machine, or nullptr
+    const json* benchmark(const std::string& file) const {
+        const json* model = find(file);
+        if (!model || !model->contains("benchmarks")) return nullptr;
+        const auto found = (*model)["benchmarks"].find(host_name());
+        return found == (*model)["benchmarks"].end() ? nullptr : &*found;
+    }
+
+    void record_checksum(const std::string& file, const std::string& sha256, uint64_t size, const std::string& source) {
+        json& model = entry(file);
+        model["sha256"] = sha256;
+        model["size"] = size;
+        model["source"] = source;
+    }
+
+    void record_benchmark(const std::string& file, json benchmark) {
+        entry(file)["benchmarks"][host_name()] = std::move(benchmark);
+    }
+
+    bool save() {
+        data_["version"] = 1;
+        std::ofstream file(path_);
+        file << data_.dump(2) << std::endl;
+        if (!file) {
+            std::cerr << "Failed to write " << path_.string() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    std::filesystem::path path_;
+    json data_ = json::object();
+};
+
+std::filesystem::path models_dir(const Settings& settings) {
+    const std::filesystem::path dir = std::filesystem::path(expand_home(settings.model_path)).parent_path();
+    return dir.empty() ? std::filesystem::path(".") : dir;
+}
+
+// Local ggml models, sorted by name
+std::vector<std::string> local_models(const std::filesystem::path& dir) {
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (entry.is_regular_file(ec) && name.rfind("ggml-", 0) == 0 && entry.path().extension() == ".bin" &&
+            name.find("silero") == std::string::npos) {
+            files.push_back(name);
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// A path to an existing file, or a model name in the models directory
+std::filesystem::path resolve_model(const std::filesystem::path& dir, const std::string& name) {
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(name, ec)) return name;
+    return dir / model_file_name(name);
+}
+
+// .en models only transcribe English
+bool supports_language(const std::string& file, const std::string& language) {
+    return language == "en" || file.find(".en") == std::string::npos;
+}
+
+double decode_ms(const json& benchmark) {
+    return benchmark.value("decode_ms", 0.0);
+}
+
+int list_models(const Settings& settings, const std::filesystem::path& dir) {
+    const Manifest manifest(dir);
+    const std::vector<std::string> files = local_models(dir);
+    const std::string current = std::filesystem::path(expand_home(settings.model_path)).filename().string();
+
+    std::cout << "Models in " << dir.string() << " (" << host_name() << "):" << std::endl;
+    if (files.empty()) {
+        std::cout << "  none - try: --models download base.en" << std::endl;
+        return 0;
+    }
+
+    std::printf("  %-32s %9s %9s %9s %12s %7s %9s\n", "", "size", "checksum", "load ms", "10s decode", "RTF", "memory");
+    for (const auto& file : files) {
+        std::error_code ec;
+        const double size_mb = std::filesystem::file_size(dir / file, ec) / (1024.0 * 1024.0);
+        const json* model = manifest.find(file);
+        const char* checksum = model && model->contains("sha256") ? "recorded" : "-";
+
+        char measured[64] = "         -            -       -         -";
+        if (const json* bench = manifest.benchmark(file)) {
+            std::snprintf(measured, sizeof(measured), "%9.0f %9.0f ms %7.3f %6.0f MB", bench->value("load_ms", 0.0),
+                          decode_ms(*bench), decode_ms(*bench) / (kBenchSeconds * 1000.0),
+                          bench->value("memory_bytes", 0.0) / (1024.0 * 1024.0));
+        }
+        std::printf("%s %-32s %6.0f MB %9s %s\n", file == current ? "*" : " ", file.c_str(), size_mb, checksum, measured);
+    }
+
+    Settings selected = settings;
+    if (select_auto_model(selected, true)) {
+        std::cout << "model_size \"auto\" with a " << settings.model_latency_target_ms << " ms target picks "
+                  << std::filesystem::path(selected.model_path).filename().string() << std::endl;
+    } else {
+        std::cout << "Run --models bench to measure them for model_size \"auto\"" << std::endl;
+    }
+    return 0;
+}
+
+int download_model(const std::filesystem::path& dir, const std::string& name) {
+    const std::string file = model_file_name(name);
+    const std::filesystem::path path = dir / file;
+
+    std::string expected;
+    uint64_t expected_size = 0;
+    if (!fetch_upstream_checksum(file, expected, expected_size)) {
+        std::cerr << file << " is not available from " << kDownloadUrl
+                  << " (quantize a local model instead: --models quantize MODEL q5_1)" << std::endl;
+        return 1;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    Manifest manifest(dir);
+
+    // A download is verified as .part before it takes the model's name. A file that was
+    // already there is never deleted: a mismatch is only reported.
+    const bool existing = std::filesystem::exists(path, ec);
+    const std::filesystem::path partial = path.string() + ".part";
+    if (!existing) {
+        std::cout << "Downloading " << file << " (" << expected_size / (1024 * 1024) << " MB)" << std::endl;
+        if (!run_curl({"-fL", "--progress-bar", "-o", partial.string(), std::string(kDownloadUrl) + file}, nullptr)) {
+            std::filesystem::remove(partial, ec);
+            std::cerr << "Download failed: " << file << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Verifying " << file << "..." << std::endl;
+    const std::string actual = file_sha256(existing ? path : partial);
+    if (actual != expected) {
+        std::cerr << "Checksum mismatch for " << file << ": expected " << expected << ", got " << actual << std::endl;
+        if (existing) {
+            std::cerr << "Left " << path.string() << " in place - remove it to download it again" << std::endl;
+        } else {
+            std::filesystem::remove(partial, ec);
+        }
+        return 1;
+    }
+
+    if (!existing) {
+        std::filesystem::rename(partial, path, ec);
+        if (ec) {
+            std::cerr << "Cannot move " << partial.string() << " to " << path.string() << ": " << ec.message() << std::endl;
+            return 1;
+        }
+    }
+
+    manifest.record_checksum(file, actual, expected_size, std::string(kDownloadUrl) + file);
+    std::cout << file << ": sha256 " << actual << " OK" << std::endl;
+    return manifest.save() ? 0 : 1;
+}
+
+int verify_models(const std::filesystem::path& dir, std::vector<std::string> names) {
+    if (names.empty()) names = local_models(dir);
+    Manifest manifest(dir);
+
+    int failed = 0;
+    for (const auto& name : names) {
+        const std::filesystem::path path = resolve_model(dir, name);
+        const std::string file = path.filename().string();
+        const std::string actual = file_sha256(path);
+        if (actual.empty()) {
+            std::cerr << file << ": cannot read " << path.string() << std::endl;
+            ++failed;
+            continue;
+        }
+
+        // Files never recorded here are checked against the upstream repository
+        std::string expected;
+        uint64_t size = 0;
+        const json* model = manifest.find(file);
+        if (model && model->contains("sha256")) {
+            expected = (*model)["sha256"];
+        } else if (fetch_upstream_checksum(file, expected, size)) {
+            manifest.record_checksum(file, expected, size, std::string(kDownloadUrl) + file);
+        } else {
+            std::cout << file << ": no checksum on record or upstream (sha256 " << actual << ")" << std::endl;
+            continue;
+        }
+
+        if (actual == expected) {
+            std::cout << file << ": OK" << std::endl;
+        } else {
+            std::cerr << file << ": checksum mismatch (expected " << expected << ", got " << actual << ")" << std::endl;
+            ++failed;
+        }
+    }
+
+    manifest.save();
+    return failed == 0 ? 0 : 1;
+}
+
+// Rewrites the ggml header with the new ftype, then lets whisper.cpp's shared quantizer
+// (examples/common-ggml.cpp) convert the tensors - the same steps as its quantize tool
+bool quantize_file(const std::filesystem::path& input, const std::filesystem::path& output, ggml_ftype ftype) {
+    std::ifstream finp(input, std::ios::binary);
+    std::ofstream fout(output, std::ios::binary);
+    if (!finp.is_open() || !fout.is_open()) {
+        std::cerr << "Cannot open " << (finp.is_open() ? output : input).string() << std::endl;
+        return false;
+    }
+
+    uint32_t magic = 0;
+    finp.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    if (magic != GGML_FILE_MAGIC) {
+        std::cerr << input.string() << " is not a ggml model" << std::endl;
+        return false;
+    }
+    fout.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+
+    // n_vocab, n_audio_ctx/state/head/layer, n_text_ctx/state/head/layer, n_mels, ftype
+    int32_t hparams[11];
+    finp.read(reinterpret_cast<char*>(hparams), sizeof(hparams));
+    if (hparams[10] % GGML_QNT_VERSION_FACTOR > 1) {
+        std::cerr << input.string() << " is already quantized - start from the f16 model" << std::endl;
+        return false;
+    }
+    hparams[10] = GGML_QNT_VERSION * GGML_QNT_VERSION_FACTOR + ftype;
+    fout.write(reinterpret_cast<const char*>(hparams), sizeof(hparams));
+
+    // Mel filters
+    int32_t n_mel = 0, n_fft = 0;
+    finp.read(reinterpret_cast<char*>(&n_mel), sizeof(n_mel));
+    finp.read(reinterpret_cast<char*>(&n_fft), sizeof(n_fft));
+    std::vector<float> filters(static_cast<size_t>(std::max(0, n_mel)) * std::max(0, n_fft));
+    finp.read(reinterpret_cast<char*>(filters.data()), filters.size() * sizeof(float));
+    fout.write(reinterpret_cast<const char*>(&n_mel), sizeof(n_mel));
+    fout.write(reinterpret_cast<const char*>(&n_fft), sizeof(n_fft));
+    fout.write(reinterpret_cast<const char*>(filters.data()), filters.size() * sizeof(float));
+
+    // Vocabulary
+    int32_t n_vocab = 0;
+    finp.read(reinterpret_cast<char*>(&n_vocab), sizeof(n_vocab));
+    fout.write(reinterpret_cast<const char*>(&n_vocab), sizeof(n_vocab));
+    std::string word;
+    for (int32_t i = 0; i < n_vocab && finp; ++i) {
+        uint32_t length = 0;
+        finp.read(reinterpret_cast<char*>(&length), sizeof(length));
+        word.resize(length);
+        finp.read(word.data(), length);
+        fout.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        fout.write(word.data(), length);
+    }
+    if (!finp) {
+        std::cerr << input.string() << " is truncated" << std::endl;
+        return false;
+    }
+
+    return ggml_common_quantize_0(finp, fout, ftype, {".*"}, kQuantizeSkip) && fout.good();
+}
+
+int quantize_model(const std::filesystem::path& dir, const std::string& name, const std::string& type) {
+    static const char* types[] = {"q4_0", "q5_0", "q5_1", "q8_0"};
+    if (std::find(std::begin(types), std::end(types), type) == std::end(types)) {
+        std::cerr << "Unsupported quantization: " << type << " (q4_0, q5_0, q5_1, q8_0)" << std::endl;
+        return 1;
+    }
+
+    const std::filesystem::path input = resolve_model(dir, name);
+    const std::string input_file = input.filename().string();
+    if (!quantization_of(input_file).empty()) {
+        std::cerr << input_file << " is already quantized - start from the f16 model" << std::endl;
+        return 1;
+    }
+
+    const std::string output_file = input.stem().string() + "-" + type + ".bin";
+    const std::filesystem::path output = dir / output_file;
+    std::cout << "Quantizing " << input.string() << " -> " << output.string() << std::endl;
+
+    const auto start = std::chrono::steady_clock::now();
+    if (!quantize_file(input, output, ggml_parse_ftype(type.c_str()))) {
+        std::error_code ec;
+        std::filesystem::remove(output, ec);
+        std::cerr << "Quantization failed" << std::endl;
+        return 1;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::error_code ec;
+    const uint64_t before = std::filesystem::file_size(input, ec);
+    const uint64_t after = std::filesystem::file_size(output, ec);
+    std::printf("%s: %.0f MB -> %.0f MB in %.1fs\n", output_file.c_str(), before / (1024.0 * 1024.0),
+                after / (1024.0 * 1024.0), seconds);
+
+    // Recorded so verify can later tell the file was not corrupted
+    Manifest manifest(dir);
+    manifest.record_checksum(output_file, file_sha256(output), after, input_file + " quantized to " + type);
+    return manifest.save() ? 0 : 1;
+}
+
+// Load time, decode time for 10 s of speech and memory of each model, as the CLI runs it
+int bench_models(const Settings& settings, const std::filesystem::path& dir, std::vector<std::string> names) {
+    if (names.empty()) names = local_models(dir);
+
+    AudioFile audio;
+    std::string error;
+    if (!read_audio_file(kBenchClip, audio, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    resample_audio_file(audio, 16000);
+    if (audio.samples.empty()) {
+        std::cerr << kBenchClip << " has no audio" << std::endl;
+        return 1;
+    }
+    AudioBuffer clip(static_cast<size_t>(kBenchSeconds) * 16000);
+    for (size_t i = 0; i < clip.size(); ++i) clip[i] = audio.samples[i % audio.samples.size()];
+
+    Settings run_settings = settings;
+    run_settings.print_progress = false;
+    apply_decode_preset(run_settings, true);  // The latency target is a dictation latency
+
+    Manifest manifest(dir);
+    std::printf("%-32s %9s %12s %7s %9s\n", "model", "load ms", "10s decode", "RTF", "memory");
+    for (const auto& name : names) {
+        const std::filesystem::path path = resolve_model(dir, name);
+        const std::string file = path.filename().string();
+
+        auto whisper = create_whisper_wrapper();
+        const auto load_start = std::chrono::steady_clock::now();
+        if (!whisper->load_model(path.string(), model_load_options(settings))) {
+            std::cerr << "Skipping " << file << ": failed to load" << std::endl;
+            continue;
+        }
+        const double load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_start).count();
+
+        whisper->transcribe_segments(clip, 16000, run_settings);  // Warm-up
+        std::vector<double> times;
+        for (int run = 0; run < kBenchRuns; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            whisper->transcribe_segments(clip, 16000, run_settings);
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::sort(times.begin(), times.end());
+        const double decode = times[times.size() / 2];
+        const size_t memory = whisper->memory_stats().total_bytes();
+
+        std::printf("%-32s %9.0f %9.0f ms %7.3f %6.0f MB\n", file.c_str(), load_ms, decode,
+                    decode / (kBenchSeconds * 1000.0), memory / (1024.0 * 1024.0));
+        manifest.record_benchmark(file, {{"load_ms", load_ms},
+                                         {"decode_ms", decode},
+                                         {"memory_bytes", memory},
+                                         {"threads", settings.num_threads},
+                                         {"gpu", settings.use_gpu},
+                                         {"source", "--models bench"}});
+    }
+
+    return manifest.save() ? 0 : 1;
+}
+
+// Take per-model results from SuperWhisperBench --json: the run closest to 10 s of audio
+// with this config's live decode preset and thread count, scaled to 10 s
+int import_benchmarks(const Settings& settings, const std::filesystem::path& dir, const std::string& report_path) {
+    json report;
+    try {
+        std::ifstream file(report_path);
+        report = json::parse(file);
+    } catch (const std::exception& e) {
+        std::cerr << "Cannot read benchmark report " << report_path << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    const std::string preset = settings.decode_preset == "auto" ? "interactive" : settings.decode_preset;
+
+    Manifest manifest(dir);
+    int imported = 0;
+    for (const auto& model : report.value("models", json::array())) {
+        const json* best = nullptr;
+        auto distance = [&](const json& run) {
+            return std::abs(run.value("audio_seconds", 0) - kBenchSeconds) * 100 +
+                   (run.value("preset", "custom") == preset ? 0 : 10) +
+                   (run.value("threads", 0) == settings.num_threads ? 0 : 1);
+        };
+        for (const auto& run : model.value("runs", json::array())) {
+            if (!best || distance(run) < distance(*best)) best = &run;
+        }
+        if (!best) continue;
+
+        const std::string file = std::filesystem::path(model.value("model", "")).filename().string();
+        manifest.record_benchmark(file, {{"load_ms", model.value("load_ms", 0.0)},
+                                         {"decode_ms", best->value("rtf", 0.0) * kBenchSeconds * 1000.0},
+                                         {"memory_bytes", model.value("loaded_rss_bytes", 0)},
+                                         {"threads", best->value("threads", 0)},
+                                         {"gpu", model.value("gpu", true)},
+                                         {"source", report_path}});
+        std::cout << "Imported " << file << std::endl;
+        ++imported;
+    }
+
+    if (imported == 0) {
+        std::cerr << "No model results in " << report_path << std::endl;
+        return 1;
+    }
+    return manifest.save() ? 0 : 1;
+}
+
+void print_usage() {
+    std::cerr << "Usage: --models list | download NAME | verify [MODEL...] | quantize MODEL q4_0|q5_0|q5_1|q8_0\n"
+              << "                | bench [MODEL...] | import BENCH.json\n"
+              << "  NAME is an upstream model such as base.en, small-q5_1 or large-v3-turbo" << std::endl;
+}
+
+} // namespace
+
+int run_models_command(const Settings& settings, const std::vector<std::string>& args) {
+    const std::filesystem::path dir = models_dir(settings);
+    const std::string command = args.empty() ? "list" : args[0];
+    const std::vector<std::string> rest(args.begin() + std::min<size_t>(1, args.size()), args.end());
+
+    if (command == "list") {
+        return list_models(settings, dir);
+    }
+    if (command == "download" && rest.size() == 1) {
+        return download_model(dir, rest[0]);
+    }
+    if (command == "verify") {
+        return verify_models(dir, rest);
+    }
+    if (command == "quantize" && rest.size() == 2) {
+        return quantize_model(dir, rest[0], rest[1]);
+    }
+    if (command == "bench") {
+        return bench_models(settings, dir, rest);
+    }
+    if (command == "import" && rest.size() == 1) {
+        return import_benchmarks(settings, dir, rest[0]);
+    }
+
+    print_usage();
+    return 1;
+}
+
+bool select_auto_model(Settings& settings, bool quiet) {
+    const std::filesystem::path dir = models_dir(settings);
+    const Manifest manifest(dir);
+
+    std::string best;
+    double best_ms = 0.0;
+    bool best_meets = false;
+    for (const auto& file : local_models(dir)) {
+        const json* bench = manifest.benchmark(file);
+        if (!bench || decode_ms(*bench) <= 0.0 || !supports_language(file, settings.language)) continue;
+
+        // Most accurate within the target; if nothing meets it, simply the fastest
+        const double ms = decode_ms(*bench);
+        const bool meets = ms <= settings.model_latency_target_ms;
+        const bool better = best.empty() || (meets && !best_meets) ||
+                            (meets && best_meets && (accuracy_rank(file) > accuracy_rank(best) ||
+                                                     (accuracy_rank(file) == accuracy_rank(best) && ms < best_ms))) ||
+                            (!meets && !best_meets && ms < best_ms);
+        if (better) {
+            best = file;
+            best_ms = ms;
+            best_meets = meets;
+        }
+    }
+
+    if (best.empty()) {
+        if (!quiet) {
+            std::cerr << "model_size \"auto\": no models benchmarked on this machine, using " << settings.model_path
+                      << " (run --models bench)" << std::endl;
+        }
+        return false;
+    }
+
+    settings.model_path = (dir / best).string();
+    if (!quiet) {
+        std::cerr << "model_size \"auto\": " << best << " (" << std::lround(best_ms) << " ms per " << kBenchSeconds
+                  << "s of audio" << (best_meets ? "" : ", slower than the target") << ")" << std::endl;
+    }
+    return true;
+}
+
+} // namespace SuperWhisper
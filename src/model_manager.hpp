@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace SuperWhisper {
+
+struct Settings;
+
+// --models CMD [ARGS]: list, download, verify, quantize and benchmark the ggml models in
+// the directory of settings.model_path. Checksums and measurements are kept in models.json
+// there, per host, so model_size "auto" can choose between them. Returns the exit code.
+int run_models_command(const Settings& settings, const std::vector<std::string>& args);
+
+// model_size "auto": point settings.model_path at the most accurate local model whose
+// benchmarked time to decode 10 s of audio on this host is within model_latency_target_ms
+// (the fastest one if none is). False, model_path unchanged, if nothing was benchmarked here.
+bool select_auto_model(Settings& settings, bool quiet = false);
+
+} // namespace SuperWhisper
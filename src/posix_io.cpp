@@ -0,0 +1,134 @@
+#include "posix_io.hpp"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace SuperWhisper {
+
+int socket_cloexec(int domain, int type) {
+#ifdef SOCK_CLOEXEC
+    return socket(domain, type | SOCK_CLOEXEC, 0);
+#else
+    const int fd = socket(domain, type, 0);
+    if (fd >= 0) fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return fd;
+#endif
+}
+
+int accept_cloexec(int listen_fd) {
+#ifdef SOCK_CLOEXEC
+    return accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+#else
+    const int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd >= 0) fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return fd;
+#endif
+}
+
+bool pipe_cloexec(int fds[2]) {
+#ifdef __APPLE__
+    if (pipe(fds) != 0) return false;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+#else
+    return pipe2(fds, O_CLOEXEC) == 0;
+#endif
+}
+
+ProcessResult run_process(const std::vector<std::string>& argv, const ProcessIo& io) {
+    ProcessResult result;
+    if (argv.empty() || (io.input && io.output)) {
+        std::cerr << "run_process: needs a program and at most one of input and output" << std::endl;
+        return result;
+    }
+
+    std::vector<char*> args;
+    for (const auto& arg : argv) args.push_back(const_cast<char*>(arg.c_str()));
+    args.push_back(nullptr);
+
+    // Parent's end and child's end of the one pipe, if any
+    const bool piped = io.input || io.output;
+    int pipe_fds[2] = {-1, -1};
+    if (piped && !pipe_cloexec(pipe_fds)) {
+        std::cerr << "Cannot create a pipe for " << argv[0] << ": " << std::strerror(errno) << std::endl;
+        return result;
+    }
+    const int parent_fd = io.input ? pipe_fds[1] : pipe_fds[0];
+    const int child_fd = io.input ? pipe_fds[0] : pipe_fds[1];
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+
+    // dup2 clears close-on-exec on the copy, so the child still gets its end
+    if (io.input) {
+        posix_spawn_file_actions_adddup2(&actions, child_fd, STDIN_FILENO);
+    }
+    if (io.output) {
+        posix_spawn_file_actions_adddup2(&actions, child_fd, STDOUT_FILENO);
+    } else if (io.discard_output) {
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    }
+
+    // Descriptors someone opened without close-on-exec (libraries, audio drivers) stay out too
+#ifdef __APPLE__
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_CLOEXEC_DEFAULT);
+    if (!io.input) posix_spawn_file_actions_addinherit_np(&actions, STDIN_FILENO);
+    if (!io.output && !io.discard_output) posix_spawn_file_actions_addinherit_np(&actions, STDOUT_FILENO);
+    posix_spawn_file_actions_addinherit_np(&actions, STDERR_FILENO);
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 34))
+    posix_spawn_file_actions_addclosefrom_np(&actions, STDERR_FILENO + 1);
+#endif
+
+    pid_t pid;
+    const int spawned = posix_spawnp(&pid, args[0], &actions, &attributes, args.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+    if (piped) close(child_fd);
+
+    if (spawned != 0) {
+        if (piped) close(parent_fd);
+        return result;
+    }
+    result.started = true;
+
+    if (io.input) {
+        const std::string& input = *io.input;
+        for (size_t offset = 0; offset < input.size();) {
+            const ssize_t n = write(parent_fd, input.data() + offset, input.size() - offset);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                result.input_written = false;  // EPIPE: the child exited early
+                break;
+            }
+            offset += static_cast<size_t>(n);
+        }
+    } else if (io.output) {
+        char chunk[64 * 1024];
+        ssize_t n;
+        while ((n = read(parent_fd, chunk, sizeof(chunk))) != 0) {
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            io.output->append(chunk, static_cast<size_t>(n));
+        }
+    }
+    if (piped) close(parent_fd);
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    if (WIFEXITED(status)) result.exit_code = WEXITSTATUS(status);
+    return result;
+}
+
+} // namespace SuperWhisper
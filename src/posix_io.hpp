@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace SuperWhisper {
+
+// Descriptors that are close-on-exec from the moment they exist, so a child process
+// (ffmpeg, curl, a clipboard helper that outlives us) never inherits them.
+// Atomic where the platform allows (SOCK_CLOEXEC, accept4); set right after elsewhere.
+
+// socket(domain, type, 0); -1 with errno set on failure
+int socket_cloexec(int domain, int type);
+
+// accept() without the peer address; -1 with errno set on failure
+int accept_cloexec(int listen_fd);
+
+// pipe() with both ends close-on-exec; false with errno set on failure
+bool pipe_cloexec(int fds[2]);
+
+// How run_process wires the child's standard streams. stderr is always inherited.
+struct ProcessIo {
+    const std::string* input = nullptr;  // Written to stdin, which is then closed (inherited when null)
+    std::string* output = nullptr;       // stdout captured here (inherited when null)
+    bool discard_output = false;         // stdout to /dev/null instead
+};
+
+struct ProcessResult {
+    bool started = false;  // False if the program could not be spawned (not installed, ...)
+    int exit_code = -1;    // -1 if it did not exit normally (killed by a signal)
+    bool input_written = true;  // False if the child stopped reading its input early
+
+    bool ok() const { return started && exit_code == 0 && input_written; }
+};
+
+// Run argv[0] (searched on PATH unless it contains a '/') to completion.
+// The child gets stdin, stdout and stderr only: every other descriptor is closed
+// in it where the platform allows, and ours are close-on-exec either way.
+// At most one of io.input and io.output may be set.
+ProcessResult run_process(const std::vector<std::string>& argv, const ProcessIo& io = {});
+
+} // namespace SuperWhisper
@@ -0,0 +1,116 @@
+#include "profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace SuperWhisper {
+namespace profiler {
+
+namespace {
+
+struct Event {
+    const char* name;
+    Clock::time_point start;
+    Clock::time_point end;
+    int thread;
+    int utterance;
+};
+
+std::atomic<bool> g_enabled{false};
+std::mutex g_mutex;
+std::vector<Event> g_events;  // All utterances, for the trace export
+std::map<std::thread::id, int> g_threads;  // Small stable ids for trace rows
+Clock::time_point g_origin = Clock::now();
+Clock::time_point g_utterance_start = g_origin;
+int g_utterance = 0;
+
+double to_ms(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+void enable(bool on) {
+    g_enabled = on;
+}
+
+bool enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void begin_utterance() {
+    if (!enabled()) return;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    ++g_utterance;
+    g_utterance_start = Clock::now();
+}
+
+void record(const char* name, Clock::time_point start, Clock::time_point end) {
+    if (!enabled()) return;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto thread = g_threads.try_emplace(std::this_thread::get_id(), static_cast<int>(g_threads.size()) + 1).first;
+    g_events.push_back({name, start, end, thread->second, g_utterance});
+}
+
+void print_utterance(std::ostream& out) {
+    if (!enabled()) return;
+
+    std::vector<Event> events;
+    Clock::time_point origin;
+    int utterance;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        origin = g_utterance_start;
+        utterance = g_utterance;
+        for (const auto& event : g_events) {
+            if (event.utterance == utterance) events.push_back(event);
+        }
+    }
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.start < b.start; });
+
+    char line[128];
+    out << "\n=== Profile (utterance " << utterance << ") ===\n";
+    std::snprintf(line, sizeof(line), "%-28s %10s %10s\n", "stage", "start ms", "duration");
+    out << line;
+    for (const auto& event : events) {
+        std::snprintf(line, sizeof(line), "%-28s %10.2f %8.2f ms\n", event.name, to_ms(event.start - origin), to_ms(event.end - event.start));
+        out << line;
+    }
+    std::snprintf(line, sizeof(line), "%-28s %10s %8.2f ms\n", "stop -> result", "", to_ms(Clock::now() - origin));
+    out << line;
+    out << "=================================" << std::endl;
+}
+
+bool write_chrome_trace(const std::string& path) {
+    nlohmann::json events = nlohmann::json::array();
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        for (const auto& event : g_events) {
+            const auto start_us = std::chrono::duration_cast<std::chrono::microseconds>(event.start - g_origin).count();
+            const auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(event.end - event.start).count();
+            events.push_back({{"name", event.name},
+                              {"ph", "X"},  // Complete event: start + duration
+                              {"ts", start_us},
+                              {"dur", duration_us},
+                              {"pid", 1},
+                              {"tid", event.thread},
+                              {"args", {{"utterance", event.utterance}}}});
+        }
+    }
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << nlohmann::json{{"traceEvents", events}, {"displayTimeUnit", "ms"}}.dump() << std::endl;
+    return true;
+}
+
+} // namespace profiler
+} // namespace SuperWhisper
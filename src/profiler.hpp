@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+namespace SuperWhisper {
+namespace profiler {
+
+// Lightweight per-utterance stage timing (--profile). Everything is a no-op
+// until enable(true), so timers can stay in the hot paths permanently.
+using Clock = std::chrono::steady_clock;
+
+void enable(bool on);
+bool enabled();
+
+// Start a new utterance timeline (the stop key press); earlier events stay in the trace
+void begin_utterance();
+
+// Record a completed stage on the calling thread
+void record(const char* name, Clock::time_point start, Clock::time_point end);
+
+// Print the current utterance's stages, in start order, with offsets from its beginning
+void print_utterance(std::ostream& out);
+
+// Write every recorded event as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev)
+bool write_chrome_trace(const std::string& path);
+
+// Times the enclosing scope as one stage
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* name) : name_(name), active_(enabled()) {
+        if (active_) start_ = Clock::now();
+    }
+    ~ScopedTimer() {
+        if (active_) record(name_, start_, Clock::now());
+    }
+    
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+    
+private:
+    const char* name_;
+    bool active_;
+    Clock::time_point start_;
+};
+
+} // namespace profiler
+} // namespace SuperWhisper
@@ -0,0 +1,186 @@
+#include "resampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <tuple>
+
+namespace SuperWhisper {
+
+// Polyphase decomposition of the prototype low-pass filter
+struct FilterBank {
+    int up = 1;      // L
+    int down = 1;    // M
+    int taps = 0;    // Taps per phase
+    std::vector<float> coeffs;  // L phases x taps, oldest input sample first
+
+    const float* phase(size_t p) const { return coeffs.data() + p * taps; }
+};
+
+namespace {
+
+// Process input in blocks so the work buffer stays small and preallocated
+constexpr size_t kBlockSize = 4096;
+
+// Kaiser beta for roughly 80 dB stopband attenuation
+constexpr double kKaiserBeta = 8.0;
+
+// Passband edge as a fraction of the output Nyquist frequency
+constexpr double kRolloff = 0.92;
+
+// Zeroth-order modified Bessel function (series expansion)
+double bessel_i0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+std::shared_ptr<const FilterBank> build_bank(int up, int down, int taps) {
+    auto bank = std::make_shared<FilterBank>();
+    bank->up = up;
+    bank->down = down;
+    bank->taps = taps;
+    bank->coeffs.resize(static_cast<size_t>(up) * taps);
+
+    // Prototype runs at the upsampled rate: cut off below the lower of the two Nyquist rates
+    const size_t length = static_cast<size_t>(up) * taps;
+    const double cutoff = 0.5 * kRolloff / std::max(up, down);  // Cycles per upsampled sample
+    const double center = (length - 1) / 2.0;
+    const double i0_beta = bessel_i0(kKaiserBeta);
+
+    std::vector<double> prototype(length);
+    for (size_t n = 0; n < length; ++n) {
+        const double t = n - center;
+        const double sinc = t == 0.0 ? 1.0 : std::sin(2.0 * M_PI * cutoff * t) / (2.0 * M_PI * cutoff * t);
+        const double ratio = length > 1 ? 2.0 * n / (length - 1) - 1.0 : 0.0;
+        const double window = bessel_i0(kKaiserBeta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / i0_beta;
+        prototype[n] = 2.0 * cutoff * sinc * window;
+    }
+
+    // Split into phases, reversed so each dot product walks the input oldest-first,
+    // and normalize every phase to unity DC gain
+    for (int p = 0; p < up; ++p) {
+        double sum = 0.0;
+        for (int k = 0; k < taps; ++k) {
+            sum += prototype[p + static_cast<size_t>(taps - 1 - k) * up];
+        }
+        for (int k = 0; k < taps; ++k) {
+            const double h = prototype[p + static_cast<size_t>(taps - 1 - k) * up];
+            bank->coeffs[static_cast<size_t>(p) * taps + k] = static_cast<float>(sum != 0.0 ? h / sum : 0.0);
+        }
+    }
+
+    return bank;
+}
+
+// Filter banks are shared per ratio; the common capture ratios are built up front
+std::shared_ptr<const FilterBank> get_bank(int up, int down, int taps) {
+    static std::mutex mutex;
+    static std::map<std::tuple<int, int, int>, std::shared_ptr<const FilterBank>> cache = [] {
+        std::map<std::tuple<int, int, int>, std::shared_ptr<const FilterBank>> common;
+        common[{1, 3, 64}] = build_bank(1, 3, 64);          // 48 kHz -> 16 kHz
+        common[{160, 441, 64}] = build_bank(160, 441, 64);  // 44.1 kHz -> 16 kHz
+        return common;
+    }();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& bank = cache[{up, down, taps}];
+    if (!bank) {
+        bank = build_bank(up, down, taps);
+    }
+    return bank;
+}
+
+// Four independent accumulators let the compiler vectorize without -ffast-math
+inline float dot(const float* a, const float* b, int n) {
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    int k = 0;
+    for (; k + 4 <= n; k += 4) {
+        s0 += a[k] * b[k];
+        s1 += a[k + 1] * b[k + 1];
+        s2 += a[k + 2] * b[k + 2];
+        s3 += a[k + 3] * b[k + 3];
+    }
+    for (; k < n; ++k) {
+        s0 += a[k] * b[k];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+} // namespace
+
+PolyphaseResampler::PolyphaseResampler(int input_rate, int output_rate, int taps_per_phase)
+    : input_rate_(input_rate), output_rate_(output_rate) {
+    if (is_passthrough()) return;
+
+    const int divisor = std::gcd(input_rate, output_rate);
+    bank_ = get_bank(output_rate / divisor, input_rate / divisor, taps_per_phase);
+    work_.assign(bank_->taps - 1 + kBlockSize, 0.0f);
+}
+
+PolyphaseResampler::~PolyphaseResampler() = default;
+
+size_t PolyphaseResampler::max_output(size_t count) const {
+    if (is_passthrough()) return count;
+    return count * bank_->up / bank_->down + 2;
+}
+
+void PolyphaseResampler::reset() {
+    std::fill(work_.begin(), work_.end(), 0.0f);
+    position_ = 0;
+}
+
+size_t PolyphaseResampler::process(const float* input, size_t count, float* output) {
+    if (is_passthrough()) {
+        std::copy(input, input + count, output);
+        return count;
+    }
+
+    size_t written = 0;
+    const size_t history = bank_->taps - 1;
+
+    while (count > 0) {
+        const size_t block = std::min(count, kBlockSize);
+        std::copy(input, input + block, work_.begin() + history);
+        written += process_block(block, output + written);
+        input += block;
+        count -= block;
+    }
+
+    return written;
+}
+
+size_t PolyphaseResampler::process_block(size_t count, float* output) {
+    const size_t up = bank_->up;
+    const size_t down = bank_->down;
+    const int taps = bank_->taps;
+
+    size_t written = 0;
+    for (size_t newest = position_ / up; newest < count; newest = position_ / up) {
+        // work_[newest .. newest + taps) ends at the block's sample `newest`
+        output[written++] = dot(bank_->phase(position_ % up), work_.data() + newest, taps);
+        position_ += down;
+    }
+    position_ -= count * up;
+
+    // Keep the last taps - 1 samples as history for the next block
+    std::copy(work_.begin() + count, work_.begin() + count + taps - 1, work_.begin());
+    return written;
+}
+
+size_t PolyphaseResampler::flush(float* output) {
+    if (is_passthrough()) return 0;
+
+    // Push one filter length of silence through, written straight into the work buffer
+    const size_t history = bank_->taps - 1;
+    std::fill_n(work_.begin() + history, bank_->taps, 0.0f);
+    return process_block(bank_->taps, output);
+}
+
+} // namespace SuperWhisper
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace SuperWhisper {
+
+struct FilterBank;
+
+// Streaming polyphase FIR resampler (Kaiser-windowed sinc).
+// The rate ratio is reduced to L/M and the prototype filter is split into L
+// phases of taps_per_phase contiguous coefficients, so every output sample is a
+// single SIMD-friendly dot product. Filter banks are computed once per ratio and
+// shared between instances (48k->16k and 44.1k->16k are built ahead of time).
+// process() never allocates, which makes it safe for the capture callback.
+class PolyphaseResampler {
+public:
+    PolyphaseResampler(int input_rate, int output_rate, int taps_per_phase = 64);
+    ~PolyphaseResampler();
+
+    // Resample a block; keeps filter history across calls.
+    // output must hold at least max_output(count) samples. Returns samples written.
+    size_t process(const float* input, size_t count, float* output);
+
+    // Push the filter delay line out with silence at the end of a stream.
+    // output must hold at least max_output(taps_per_phase) samples.
+    size_t flush(float* output);
+
+    // Upper bound on the output produced for count input samples
+    size_t max_output(size_t count) const;
+
+    void reset();
+
+    int input_rate() const { return input_rate_; }
+    int output_rate() const { return output_rate_; }
+    bool is_passthrough() const { return input_rate_ == output_rate_; }
+
+private:
+    // Resample the block already copied into work_ after the history
+    size_t process_block(size_t count, float* output);
+
+    int input_rate_;
+    int output_rate_;
+    std::shared_ptr<const FilterBank> bank_;
+
+    // History (taps - 1 samples) followed by the current input block
+    std::vector<float> work_;
+    size_t position_ = 0;  // Output position in upsampled units, relative to the block start
+};
+
+} // namespace SuperWhisper
@@ -0,0 +1,351 @@
+#include "result_cache.hpp"
+#include "settings.hpp"
+#include "metrics.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace SuperWhisper {
+
+using json = nlohmann::json;
+
+namespace {
+
+// Bump when the entry layout or the meaning of a key changes
+constexpr int kCacheVersion = 1;
+
+// Two independent 64-bit multiply-rotate lanes over 8-byte words, ~1 cycle/byte.
+// Not cryptographic - a 128-bit key only has to make accidental collisions negligible.
+class Fingerprint {
+public:
+    void update(const void* data, size_t bytes) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        length_ += bytes;
+
+        // Finish a word left over from the previous call
+        while (tail_size_ > 0 && tail_size_ < 8 && bytes > 0) {
+            tail_[tail_size_++] = *p++;
+            --bytes;
+        }
+        if (tail_size_ == 8) {
+            mix(load(tail_));
+            tail_size_ = 0;
+        }
+
+        for (; bytes >= 8; p += 8, bytes -= 8) {
+            mix(load(p));
+        }
+        std::memcpy(tail_, p, bytes);
+        tail_size_ = bytes;
+    }
+
+    void update(const std::string& text) {
+        update(text.data(), text.size());
+        update(static_cast<uint64_t>(text.size()));
+    }
+
+    template <typename T>
+    void update(const T& value) requires std::is_arithmetic_v<T> {
+        update(&value, sizeof(value));
+    }
+
+    std::string hex() {
+        uint64_t last = 0;
+        std::memcpy(&last, tail_, tail_size_);
+        mix(last ^ length_);
+
+        char buffer[33];
+        std::snprintf(buffer, sizeof(buffer), "%016llx%016llx",
+                      static_cast<unsigned long long>(avalanche(a_)), static_cast<unsigned long long>(avalanche(b_)));
+        return buffer;
+    }
+
+private:
+    static uint64_t load(const uint8_t* p) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        return word;
+    }
+
+    static uint64_t rotl(uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    // Final mix (murmur3 fmix64)
+    static uint64_t avalanche(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    void mix(uint64_t word) {
+        a_ = rotl(a_ ^ (word * 0x87c37b91114253d5ULL), 31) * 0x4cf5ad432745937fULL;
+        b_ = rotl(b_ + (word * 0x4cf5ad432745937fULL), 29) * 0x87c37b91114253d5ULL + a_;
+    }
+
+    uint64_t a_ = 0x9e3779b97f4a7c15ULL;
+    uint64_t b_ = 0x6a09e667f3bcc908ULL;
+    uint64_t length_ = 0;
+    uint8_t tail_[8] = {};
+    size_t tail_size_ = 0;
+};
+
+json to_json(const TranscriptSegments& segments) {
+    json list = json::array();
+    for (const auto& segment : segments) {
+        list.push_back({{"start_ms", segment.start_ms},
+                        {"end_ms", segment.end_ms},
+                        {"text", segment.text},
+                        {"token_count", segment.token_count},
+                        {"avg_logprob", segment.avg_logprob},
+                        {"token_entropy", segment.token_entropy}});
+    }
+    return json{{"version", kCacheVersion}, {"segments", std::move(list)}};
+}
+
+bool from_json(const json& entry, TranscriptSegments& segments) {
+    if (entry.value("version", 0) != kCacheVersion) return false;
+
+    segments.clear();
+    for (const auto& item : entry.at("segments")) {
+        TranscriptSegment segment;
+        segment.start_ms = item.at("start_ms");
+        segment.end_ms = item.at("end_ms");
+        segment.text = item.at("text");
+        segment.token_count = item.value("token_count", 0);
+        segment.avg_logprob = item.value("avg_logprob", 0.0f);
+        segment.token_entropy = item.value("token_entropy", 0.0f);
+        segments.push_back(std::move(segment));
+    }
+    return true;
+}
+
+class DiskResultCache : public ResultCache {
+public:
+    DiskResultCache(std::filesystem::path dir, uint64_t max_bytes)
+        : dir_(std::move(dir)), max_bytes_(max_bytes) {
+        scan();
+    }
+
+    bool lookup(const std::string& key, TranscriptSegments& segments) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        const auto found = index_.find(key);
+        if (found == index_.end()) {
+            ++stats_.misses;
+            metrics::add(metrics::Counter::CacheMisses);
+            return false;
+        }
+
+        bool ok = false;
+        try {
+            std::ifstream file(path_for(key));
+            ok = file.is_open() && from_json(json::parse(file), segments);
+        } catch (const std::exception&) {
+            ok = false;
+        }
+
+        // Unreadable or from another version: treat as a miss and drop it
+        if (!ok) {
+            ++stats_.misses;
+            metrics::add(metrics::Counter::CacheMisses);
+            remove(found->second);
+            return false;
+        }
+
+        // Most recently used goes to the back; the file's mtime keeps the order across runs
+        lru_.splice(lru_.end(), lru_, found->second);
+        std::error_code ec;
+        std::filesystem::last_write_time(path_for(key), std::filesystem::file_time_type::clock::now(), ec);
+        ++stats_.hits;
+        metrics::add(metrics::Counter::CacheHits);
+        return true;
+    }
+
+    void store(const std::string& key, const TranscriptSegments& segments) override {
+        // Keep a character whisper split across segments rather than throwing
+        const std::string data = to_json(segments).dump(-1, ' ', false, json::error_handler_t::replace);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Write to a temporary name and rename, so a reader never sees half an entry
+        const std::filesystem::path path = path_for(key);
+        const std::filesystem::path temp = path.string() + ".tmp";
+        {
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            file << data;
+            if (!file) {
+                std::cerr << "Failed to write cache entry: " << temp << std::endl;
+                return;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp, path, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return;
+        }
+
+        if (const auto found = index_.find(key); found != index_.end()) {
+            remove(found->second, false);
+        }
+        lru_.push_back({key, data.size()});
+        index_[key] = std::prev(lru_.end());
+        stats_.bytes += data.size();
+
+        while (stats_.bytes > max_bytes_ && lru_.size() > 1) {
+            remove(lru_.begin());
+            ++stats_.evictions;
+        }
+        stats_.entries = lru_.size();
+    }
+
+    ResultCacheStats stats() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        uint64_t bytes = 0;
+    };
+    using EntryList = std::list<Entry>;
+
+    std::filesystem::path path_for(const std::string& key) const {
+        return dir_ / (key + ".json");
+    }
+
+    // Rebuild the LRU order from the entries' modification times
+    void scan() {
+        struct Found {
+            std::string key;
+            uint64_t bytes;
+            std::filesystem::file_time_type used;
+        };
+        std::vector<Found> found;
+
+        std::error_code ec;
+        for (const auto& file : std::filesystem::directory_iterator(dir_, ec)) {
+            if (!file.is_regular_file(ec) || file.path().extension() != ".json") continue;
+            found.push_back({file.path().stem().string(), file.file_size(ec), file.last_write_time(ec)});
+        }
+        std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.used < b.used; });
+
+        for (auto& entry : found) {
+            lru_.push_back({std::move(entry.key), entry.bytes});
+            index_[lru_.back().key] = std::prev(lru_.end());
+            stats_.bytes += entry.bytes;
+        }
+        stats_.entries = lru_.size();
+    }
+
+    // Forget an entry (and delete its file unless it is about to be replaced)
+    void remove(EntryList::iterator entry, bool delete_file = true) {
+        if (delete_file) {
+            std::error_code ec;
+            std::filesystem::remove(path_for(entry->key), ec);
+        }
+        stats_.bytes -= std::min(stats_.bytes, entry->bytes);
+        index_.erase(entry->key);
+        lru_.erase(entry);
+        stats_.entries = lru_.size();
+    }
+
+    const std::filesystem::path dir_;
+    const uint64_t max_bytes_;
+
+    mutable std::mutex mutex_;
+    EntryList lru_;  // Least recently used first
+    std::unordered_map<std::string, EntryList::iterator> index_;
+    ResultCacheStats stats_;
+};
+
+} // namespace
+
+std::string result_cache_key(const AudioView& audio, int sample_rate, const Settings& settings) {
+    Fingerprint fingerprint;
+    fingerprint.update(kCacheVersion);
+
+    // The audio itself
+    fingerprint.update(sample_rate);
+    fingerprint.update(audio.first.data(), audio.first.size_bytes());
+    fingerprint.update(audio.second.data(), audio.second.size_bytes());
+
+    // The model, including a file replaced in place under the same name
+    fingerprint.update(settings.model_path);
+    std::error_code ec;
+    fingerprint.update(static_cast<uint64_t>(std::filesystem::file_size(settings.model_path, ec)));
+    fingerprint.update(static_cast<int64_t>(
+        std::filesystem::last_write_time(settings.model_path, ec).time_since_epoch().count()));
+
+    // Decoder settings
+    fingerprint.update(settings.language);
+    fingerprint.update(settings.translate_to_english);
+    fingerprint.update(settings.max_tokens);
+    fingerprint.update(settings.temperature);
+    fingerprint.update(settings.entropy_threshold);
+    fingerprint.update(settings.logprob_threshold);
+    fingerprint.update(settings.no_speech_threshold);
+    fingerprint.update(settings.suppress_blank);
+    fingerprint.update(settings.suppress_non_speech_tokens);
+    fingerprint.update(settings.print_timestamps);  // Token-level timestamps change segmentation
+    fingerprint.update(settings.sampling_strategy);
+    fingerprint.update(settings.beam_size);
+    fingerprint.update(settings.best_of);
+    fingerprint.update(settings.temperature_inc);
+    fingerprint.update(settings.single_segment);
+    fingerprint.update(settings.no_timestamps);
+
+    // Silence trimming decides which audio reaches the model
+    fingerprint.update(settings.vad_trim_silence);
+    if (settings.vad_trim_silence) {
+        fingerprint.update(settings.vad_mode);
+        fingerprint.update(settings.vad_model_path);
+        fingerprint.update(settings.vad_hangover_ms);
+        fingerprint.update(settings.vad_speech_pad_ms);
+        fingerprint.update(settings.silence_threshold);
+    }
+
+    return fingerprint.hex();
+}
+
+std::unique_ptr<ResultCache> create_result_cache(const Settings& settings) {
+    if (!settings.result_cache) {
+        return nullptr;
+    }
+
+    const std::filesystem::path dir = expand_home(settings.cache_dir);
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        std::cerr << "Result cache disabled, cannot create " << dir.string() << ": " << ec.message() << std::endl;
+        return nullptr;
+    }
+
+    const uint64_t max_bytes = static_cast<uint64_t>(std::max(settings.cache_max_mb, 1)) * 1024 * 1024;
+    return std::make_unique<DiskResultCache>(dir, max_bytes);
+}
+
+std::string format_cache_stats(const ResultCacheStats& stats) {
+    char buffer[160];
+    std::snprintf(buffer, sizeof(buffer), "%llu hits / %llu lookups (%.1f%%), %zu entries, %.1f MB",
+                  static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.hits + stats.misses),
+                  100.0 * stats.hit_rate(), stats.entries, stats.bytes / (1024.0 * 1024.0));
+    return buffer;
+}
+
+} // namespace SuperWhisper
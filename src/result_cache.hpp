@@ -0,0 +1,51 @@
+#pragma once
+
+#include "whisper_wrapper.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace SuperWhisper {
+
+struct Settings;
+
+struct ResultCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    uint64_t bytes = 0;
+
+    double hit_rate() const {
+        const uint64_t lookups = hits + misses;
+        return lookups > 0 ? static_cast<double>(hits) / lookups : 0.0;
+    }
+};
+
+// Content-addressed cache of decoded segments. The key covers the PCM and every
+// setting that changes what the decoder produces, so a hit is exactly the segments a
+// new decode would return; output formatting is applied afterwards, so one entry
+// serves every output_format. Backed by one file per entry under cache_dir, evicted
+// least recently used first once the directory passes cache_max_mb. Thread-safe.
+class ResultCache {
+public:
+    virtual ~ResultCache() = default;
+
+    // True and fills segments on a hit (which also marks the entry recently used)
+    virtual bool lookup(const std::string& key, TranscriptSegments& segments) = 0;
+
+    virtual void store(const std::string& key, const TranscriptSegments& segments) = 0;
+
+    virtual ResultCacheStats stats() const = 0;
+};
+
+// Key for decoding `audio` at `sample_rate` with `settings` (32 hex digits)
+std::string result_cache_key(const AudioView& audio, int sample_rate, const Settings& settings);
+
+// Factory function - nullptr if result_cache is off or cache_dir cannot be created
+std::unique_ptr<ResultCache> create_result_cache(const Settings& settings);
+
+// "42 hits / 50 lookups (84.0%), 120 entries, 3.1 MB"
+std::string format_cache_stats(const ResultCacheStats& stats);
+
+} // namespace SuperWhisper
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+namespace SuperWhisper {
+
+// Read-only view of ring buffer contents as at most two contiguous spans (oldest first)
+template <typename T>
+struct RingView {
+    std::span<const T> first;
+    std::span<const T> second;
+    uint64_t start = 0;  // Absolute stream position of the first element
+
+    size_t size() const { return first.size() + second.size(); }
+    bool empty() const { return first.empty() && second.empty(); }
+    uint64_t end() const { return start + size(); }
+
+    // Copy the viewed elements into contiguous storage of at least size() elements
+    void copy_to(T* out) const {
+        std::copy(first.begin(), first.end(), out);
+        std::copy(second.begin(), second.end(), out + first.size());
+    }
+
+    // Elements [offset, offset + count) of this view, clamped to its size - no copy
+    RingView subview(size_t offset, size_t count) const {
+        offset = std::min(offset, size());
+        count = std::min(count, size() - offset);
+
+        RingView view;
+        view.start = start + offset;
+        if (offset < first.size()) {
+            const size_t head = std::min(count, first.size() - offset);
+            view.first = first.subspan(offset, head);
+            view.second = second.first(count - head);
+        } else {
+            view.first = second.subspan(offset - first.size(), count);
+        }
+        return view;
+    }
+};
+
+// Preallocated single-producer ring buffer with power-of-two capacity.
+// The producer is wait-free: write() never blocks or allocates and overwrites the
+// oldest data once full. Readers never modify the buffer - they take views by
+// absolute stream position, which stay valid as long as the producer has not
+// advanced more than capacity() elements past the view's start.
+template <typename T>
+class SpscRingBuffer {
+    static_assert(std::is_trivially_copyable_v<T>, "ring buffer elements must be trivially copyable");
+
+public:
+    explicit SpscRingBuffer(size_t min_capacity)
+        : capacity_(round_up_pow2(min_capacity)), mask_(capacity_ - 1), data_(new T[capacity_]()) {}
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // Producer side - safe to call from the real-time audio thread
+    void write(const T* data, size_t count) {
+        uint64_t pos = write_pos_.load(std::memory_order_relaxed);
+
+        // Only the newest capacity_ elements can survive anyway
+        if (count > capacity_) {
+            data += count - capacity_;
+            pos += count - capacity_;
+            count = capacity_;
+        }
+
+        const size_t offset = static_cast<size_t>(pos & mask_);
+        const size_t first = std::min(count, capacity_ - offset);
+        std::memcpy(data_.get() + offset, data, first * sizeof(T));
+        std::memcpy(data_.get(), data + first, (count - first) * sizeof(T));
+
+        write_pos_.store(pos + count, std::memory_order_release);
+    }
+
+    // Total number of elements ever written (absolute stream position)
+    uint64_t write_position() const {
+        return write_pos_.load(std::memory_order_acquire);
+    }
+
+    // View of [from, write_position()), clamped to the data still held and to max_count newest elements
+    RingView<T> view(uint64_t from, size_t max_count = SIZE_MAX) const {
+        const uint64_t end = write_position();
+        uint64_t begin = std::max(from, end > capacity_ ? end - capacity_ : 0);
+        if (begin > end) begin = end;
+        if (end - begin > max_count) begin = end - max_count;
+
+        RingView<T> view;
+        view.start = begin;
+
+        const size_t count = static_cast<size_t>(end - begin);
+        const size_t offset = static_cast<size_t>(begin & mask_);
+        const size_t first = std::min(count, capacity_ - offset);
+        view.first = std::span<const T>(data_.get() + offset, first);
+        view.second = std::span<const T>(data_.get(), count - first);
+        return view;
+    }
+
+    // True if a view taken earlier has not been overwritten by the producer since
+    bool is_intact(const RingView<T>& view) const {
+        return write_position() - view.start <= capacity_;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    static size_t round_up_pow2(size_t n) {
+        size_t capacity = 1;
+        while (capacity < n) capacity <<= 1;
+        return capacity;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> data_;
+
+    // Keep the producer's counter on its own cache line
+    alignas(64) std::atomic<uint64_t> write_pos_{0};
+};
+
+} // namespace SuperWhisper
@@ -0,0 +1,255 @@
+#include "segment_sink.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+
+namespace SuperWhisper {
+
+namespace {
+
+// Numbers go through a stack buffer: nothing here allocates once `out` has grown
+
+void append_integer(int64_t value, std::string& out) {
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+// Milliseconds as seconds with three decimals ("12.340")
+void append_seconds(int64_t ms, std::string& out) {
+    ms = std::max<int64_t>(ms, 0);
+    char buffer[32];
+    const int n = std::snprintf(buffer, sizeof(buffer), "%lld.%03lld",
+                                static_cast<long long>(ms / 1000), static_cast<long long>(ms % 1000));
+    out.append(buffer, static_cast<size_t>(n));
+}
+
+// Subtitle cue time: HH:MM:SS,mmm (SRT) or HH:MM:SS.mmm (VTT)
+void append_clock(int64_t ms, char separator, std::string& out) {
+    ms = std::max<int64_t>(ms, 0);
+    char buffer[32];
+    const int n = std::snprintf(buffer, sizeof(buffer), "%02lld:%02lld:%02lld%c%03lld",
+                                static_cast<long long>(ms / 3600000), static_cast<long long>(ms / 60000 % 60),
+                                static_cast<long long>(ms / 1000 % 60), separator, static_cast<long long>(ms % 1000));
+    out.append(buffer, static_cast<size_t>(n));
+}
+
+// Length of the well-formed UTF-8 sequence starting at text[pos], 0 if there is none
+size_t utf8_sequence_length(std::string_view text, size_t pos) {
+    const unsigned char lead = static_cast<unsigned char>(text[pos]);
+    if (lead < 0x80) return 1;
+
+    size_t length;
+    uint32_t code_point;
+    uint32_t min_code_point;
+    if ((lead & 0xE0) == 0xC0) {
+        length = 2, code_point = lead & 0x1F, min_code_point = 0x80;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 3, code_point = lead & 0x0F, min_code_point = 0x800;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 4, code_point = lead & 0x07, min_code_point = 0x10000;
+    } else {
+        return 0;
+    }
+    if (pos + length > text.size()) return 0;
+
+    for (size_t i = 1; i < length; ++i) {
+        const unsigned char next = static_cast<unsigned char>(text[pos + i]);
+        if ((next & 0xC0) != 0x80) return 0;
+        code_point = (code_point << 6) | (next & 0x3F);
+    }
+
+    // Overlong encodings, surrogates and values past Unicode are not valid either
+    if (code_point < min_code_point || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+        return 0;
+    }
+    return length;
+}
+
+// Cue text must stay on its lines: a blank line ends an SRT/VTT cue early
+void append_cue_text(std::string_view text, bool vtt, std::string& out) {
+    for (size_t i = 0; i < text.size(); ++i) {
+        const char c = text[i];
+        if (c == '\n' || c == '\r') {
+            out += ' ';
+        } else if (vtt && c == '&') {
+            out += "&amp;";
+        } else if (vtt && c == '<') {
+            out += "&lt;";
+        } else if (vtt && c == '>') {
+            out += "&gt;";  // Also keeps "-->" out of the cue payload
+        } else {
+            out += c;
+        }
+    }
+}
+
+class TextSink : public SegmentSink {
+public:
+    void begin(std::string&) const override {}
+
+    void write(const TranscriptSegment& segment, size_t, std::string& out) const override {
+        out += segment.text;
+    }
+
+    void end(std::string&) const override {}
+};
+
+class JsonSink : public SegmentSink {
+public:
+    void begin(std::string& out) const override {
+        out += "{\n  \"segments\": [";
+    }
+
+    void write(const TranscriptSegment& segment, size_t index, std::string& out) const override {
+        out += index > 0 ? ",\n    {\n      \"id\": " : "\n    {\n      \"id\": ";
+        append_integer(static_cast<int64_t>(index), out);
+        out += ",\n      \"start\": ";
+        append_seconds(segment.start_ms, out);
+        out += ",\n      \"end\": ";
+        append_seconds(segment.end_ms, out);
+        out += ",\n      \"text\": \"";
+        append_json_escaped(segment.text, out);
+        out += "\"\n    }";
+    }
+
+    void end(std::string& out) const override {
+        out += "\n  ]\n}";
+    }
+};
+
+class SrtSink : public SegmentSink {
+public:
+    void begin(std::string&) const override {}
+
+    void write(const TranscriptSegment& segment, size_t index, std::string& out) const override {
+        append_integer(static_cast<int64_t>(index) + 1, out);
+        out += '\n';
+        append_clock(segment.start_ms, ',', out);
+        out += " --> ";
+        append_clock(segment.end_ms, ',', out);
+        out += '\n';
+        append_cue_text(segment.text, false, out);
+        out += "\n\n";
+    }
+
+    void end(std::string&) const override {}
+};
+
+class VttSink : public SegmentSink {
+public:
+    void begin(std::string& out) const override {
+        out += "WEBVTT\n\n";
+    }
+
+    void write(const TranscriptSegment& segment, size_t, std::string& out) const override {
+        append_clock(segment.start_ms, '.', out);
+        out += " --> ";
+        append_clock(segment.end_ms, '.', out);
+        out += '\n';
+        append_cue_text(segment.text, true, out);
+        out += "\n\n";
+    }
+
+    void end(std::string&) const override {}
+};
+
+class CsvSink : public SegmentSink {
+public:
+    void begin(std::string& out) const override {
+        out += "start_time,end_time,text\n";
+    }
+
+    void write(const TranscriptSegment& segment, size_t, std::string& out) const override {
+        append_seconds(segment.start_ms, out);
+        out += ',';
+        append_seconds(segment.end_ms, out);
+        out += ',';
+        append_csv_field(segment.text, out);
+        out += '\n';
+    }
+
+    void end(std::string&) const override {}
+};
+
+} // namespace
+
+const SegmentSink& get_segment_sink(const std::string& format) {
+    static const TextSink text;
+    static const JsonSink json;
+    static const SrtSink srt;
+    static const VttSink vtt;
+    static const CsvSink csv;
+
+    if (format == "json") return json;
+    if (format == "srt") return srt;
+    if (format == "vtt") return vtt;
+    if (format == "csv") return csv;
+    return text;
+}
+
+void append_json_escaped(std::string_view text, std::string& out) {
+    static constexpr char kHex[] = "0123456789abcdef";
+
+    for (size_t i = 0; i < text.size();) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        switch (c) {
+            case '"':  out += "\\\""; ++i; continue;
+            case '\\': out += "\\\\"; ++i; continue;
+            case '\n': out += "\\n"; ++i; continue;
+            case '\r': out += "\\r"; ++i; continue;
+            case '\t': out += "\\t"; ++i; continue;
+            case '\b': out += "\\b"; ++i; continue;
+            case '\f': out += "\\f"; ++i; continue;
+            default: break;
+        }
+
+        if (c < 0x20) {
+            out += "\\u00";
+            out += kHex[c >> 4];
+            out += kHex[c & 0x0F];
+            ++i;
+            continue;
+        }
+
+        // Whisper tokens are bytes, so a segment can begin or end inside a character
+        const size_t length = utf8_sequence_length(text, i);
+        if (length == 0) {
+            out += "\\ufffd";
+            ++i;
+        } else {
+            out.append(text.data() + i, length);
+            i += length;
+        }
+    }
+}
+
+void append_csv_field(std::string_view text, std::string& out) {
+    out += '"';
+    for (const char c : text) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+// Renders through the sinks; kept for callers that want the whole transcript at once
+std::string format_transcript(const TranscriptSegments& segments, const std::string& format) {
+    std::string transcription;
+    format_transcript(segments, format, transcription);
+    return transcription;
+}
+
+void format_transcript(std::span<const TranscriptSegment> segments, const std::string& format, std::string& transcription) {
+    transcription.clear();
+
+    const SegmentSink& sink = get_segment_sink(format);
+    sink.begin(transcription);
+    for (size_t i = 0; i < segments.size(); ++i) {
+        sink.write(segments[i], i, transcription);
+    }
+    sink.end(transcription);
+}
+
+} // namespace SuperWhisper
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "whisper_wrapper.hpp"
+#include <string>
+#include <string_view>
+
+namespace SuperWhisper {
+
+// Writes transcript segments in one output format, appending to a caller-owned buffer.
+// A transcript is begin(), one write() per segment in order (index from 0), then end().
+// Segments can be written as they are decoded, with the buffer flushed in between.
+class SegmentSink {
+public:
+    virtual ~SegmentSink() = default;
+
+    virtual void begin(std::string& out) const = 0;
+    virtual void write(const TranscriptSegment& segment, size_t index, std::string& out) const = 0;
+    virtual void end(std::string& out) const = 0;
+};
+
+// Writer for text, json, srt, vtt or csv (anything else is text). Writers are
+// stateless and shared - the returned reference lives for the whole program.
+const SegmentSink& get_segment_sink(const std::string& format);
+
+// Append `text` as the inside of a JSON string: quotes, backslashes and control
+// characters escaped, invalid UTF-8 (a character split between segments) as U+FFFD
+void append_json_escaped(std::string_view text, std::string& out);
+
+// Append `text` as one quoted CSV field (RFC 4180: embedded quotes doubled)
+void append_csv_field(std::string_view text, std::string& out);
+
+} // namespace SuperWhisper
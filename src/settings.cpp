@@ -6,16 +6,47 @@
 
 namespace SuperWhisper {
 
+std::string expand_home(const std::string& path) {
+    if (!path.empty() && path[0] == '~') {
+        const char* home = getenv("HOME");
+        if (home) {
+            return std::string(home) + path.substr(1);
+        }
+    }
+    return path;
+}
+
+void apply_decode_preset(Settings& settings, bool live) {
+    std::string preset = settings.decode_preset;
+    if (preset == "auto") {
+        preset = live ? "interactive" : "accurate";
+    }
+
+    if (preset == "interactive") {
+        // Dictation: a single greedy pass, never re-decoded at a higher temperature
+        settings.sampling_strategy = "greedy";
+        settings.best_of = 1;
+        settings.temperature_inc = 0.0f;
+
+        // Streaming commits, long-form chunks and timed formats need segment boundaries
+        const bool needs_timestamps = settings.streaming_mode || settings.speculative_decode || settings.long_form ||
+                                      settings.print_timestamps || settings.output_format != "text";
+        settings.single_segment = !needs_timestamps;
+        settings.no_timestamps = !needs_timestamps;
+    } else if (preset == "accurate") {
+        settings.sampling_strategy = "beam_search";
+        settings.beam_size = 5;
+        settings.best_of = 5;
+        settings.temperature_inc = 0.2f;
+        settings.single_segment = false;
+        settings.no_timestamps = false;
+    }
+}
+
 void Settings::save(const std::string& path) {
     try {
         // Expand tilde to home directory
-        std::string expanded_path = path;
-        if (expanded_path[0] == '~') {
-            const char* home = getenv("HOME");
-            if (home) {
-                expanded_path = std::string(home) + expanded_path.substr(1);
-            }
-        }
+        std::string expanded_path = expand_home(path);
         
         // Create directory if it doesn't exist
         std::filesystem::path config_path(expanded_path);
@@ -27,18 +58,35 @@ void Settings::save(const std::string& path) {
         // Model settings
         j["model_path"] = model_path;
         j["model_size"] = model_size;
+        j["model_latency_target_ms"] = model_latency_target_ms;
         
         // Audio settings
         j["silence_duration"] = silence_duration;
         j["max_duration"] = max_duration;
         j["silence_threshold"] = silence_threshold;
         j["sample_rate"] = sample_rate;
+        j["audio_input"] = audio_input;
+        j["raw_sample_rate"] = raw_sample_rate;
+        j["raw_channels"] = raw_channels;
+        j["input_device"] = input_device;
+        j["frames_per_buffer"] = frames_per_buffer;
+        j["input_latency_ms"] = input_latency_ms;
+        j["always_armed"] = always_armed;
+        j["preroll_ms"] = preroll_ms;
+        
+        // Voice activity detection settings
+        j["vad_mode"] = vad_mode;
+        j["vad_model_path"] = vad_model_path;
+        j["vad_hangover_ms"] = vad_hangover_ms;
+        j["vad_speech_pad_ms"] = vad_speech_pad_ms;
+        j["vad_trim_silence"] = vad_trim_silence;
         
         // Whisper settings
         j["language"] = language;
         j["translate_to_english"] = translate_to_english;
         j["num_threads"] = num_threads;
         j["max_tokens"] = max_tokens;
+        j["context_tokens"] = context_tokens;
         j["temperature"] = temperature;
         j["top_p"] = top_p;
         j["top_k"] = top_k;
@@ -56,15 +104,53 @@ void Settings::save(const std::string& path) {
         j["suppress_blank"] = suppress_blank;
         j["suppress_non_speech_tokens"] = suppress_non_speech_tokens;
         
+        // Decoding strategy
+        j["decode_preset"] = decode_preset;
+        j["sampling_strategy"] = sampling_strategy;
+        j["beam_size"] = beam_size;
+        j["best_of"] = best_of;
+        j["temperature_inc"] = temperature_inc;
+        j["single_segment"] = single_segment;
+        j["no_timestamps"] = no_timestamps;
+        
         // Output settings
         j["output_format"] = output_format;
         j["output_file"] = output_file;
         j["copy_to_clipboard"] = copy_to_clipboard;
+        j["auto_paste"] = auto_paste;
+        
+        // Streaming settings
+        j["streaming_mode"] = streaming_mode;
+        j["stream_step_ms"] = stream_step_ms;
+        j["stream_window_ms"] = stream_window_ms;
+        j["stream_keep_ms"] = stream_keep_ms;
+        j["speculative_decode"] = speculative_decode;
+        j["speculative_pause_ms"] = speculative_pause_ms;
+        j["long_form"] = long_form;
+        j["long_form_chunk_ms"] = long_form_chunk_ms;
+        j["long_form_overlap_ms"] = long_form_overlap_ms;
+        
+        // Cascade settings
+        j["cascade_draft_model"] = cascade_draft_model;
+        j["cascade_logprob_threshold"] = cascade_logprob_threshold;
+        j["cascade_entropy_threshold"] = cascade_entropy_threshold;
+        
+        // Daemon settings
+        j["daemon_socket"] = daemon_socket;
+        j["metrics_port"] = metrics_port;
+        j["metrics_address"] = metrics_address;
+        
+        // Result cache settings
+        j["result_cache"] = result_cache;
+        j["cache_dir"] = cache_dir;
+        j["cache_max_mb"] = cache_max_mb;
         
         // Performance settings
         j["use_gpu"] = use_gpu;
         j["use_metal"] = use_metal;
         j["use_accelerate"] = use_accelerate;
+        j["pool_size"] = pool_size;
+        j["memory_budget_mb"] = memory_budget_mb;
         
         // Hotkey settings
         j["enable_hotkeys"] = enable_hotkeys;
@@ -89,20 +175,16 @@ void Settings::save(const std::string& path) {
     }
 }
 
-void Settings::load(const std::string& path) {
+void Settings::load(const std::string& path, bool quiet) {
     try {
         // Expand tilde to home directory
-        std::string expanded_path = path;
-        if (expanded_path[0] == '~') {
-            const char* home = getenv("HOME");
-            if (home) {
-                expanded_path = std::string(home) + expanded_path.substr(1);
-            }
-        }
+        std::string expanded_path = expand_home(path);
         
         // Check if file exists
         if (!std::filesystem::exists(expanded_path)) {
-            std::cout << "Config file not found, using defaults: " << expanded_path << std::endl;
+            if (!quiet) {
+                std::cout << "Config file not found, using defaults: " << expanded_path << std::endl;
+            }
             return; // Use defaults
         }
         
@@ -116,18 +198,35 @@ void Settings::load(const std::string& path) {
             // Load model settings
             if (j.contains("model_path")) model_path = j["model_path"];
             if (j.contains("model_size")) model_size = j["model_size"];
+            if (j.contains("model_latency_target_ms")) model_latency_target_ms = j["model_latency_target_ms"];
             
             // Load audio settings
             if (j.contains("silence_duration")) silence_duration = j["silence_duration"];
             if (j.contains("max_duration")) max_duration = j["max_duration"];
             if (j.contains("silence_threshold")) silence_threshold = j["silence_threshold"];
             if (j.contains("sample_rate")) sample_rate = j["sample_rate"];
+            if (j.contains("audio_input")) audio_input = j["audio_input"];
+            if (j.contains("raw_sample_rate")) raw_sample_rate = j["raw_sample_rate"];
+            if (j.contains("raw_channels")) raw_channels = j["raw_channels"];
+            if (j.contains("input_device")) input_device = j["input_device"];
+            if (j.contains("frames_per_buffer")) frames_per_buffer = j["frames_per_buffer"];
+            if (j.contains("input_latency_ms")) input_latency_ms = j["input_latency_ms"];
+            if (j.contains("always_armed")) always_armed = j["always_armed"];
+            if (j.contains("preroll_ms")) preroll_ms = j["preroll_ms"];
+            
+            // Load voice activity detection settings
+            if (j.contains("vad_mode")) vad_mode = j["vad_mode"];
+            if (j.contains("vad_model_path")) vad_model_path = j["vad_model_path"];
+            if (j.contains("vad_hangover_ms")) vad_hangover_ms = j["vad_hangover_ms"];
+            if (j.contains("vad_speech_pad_ms")) vad_speech_pad_ms = j["vad_speech_pad_ms"];
+            if (j.contains("vad_trim_silence")) vad_trim_silence = j["vad_trim_silence"];
             
             // Load Whisper settings
             if (j.contains("language")) language = j["language"];
             if (j.contains("translate_to_english")) translate_to_english = j["translate_to_english"];
             if (j.contains("num_threads")) num_threads = j["num_threads"];
             if (j.contains("max_tokens")) max_tokens = j["max_tokens"];
+            if (j.contains("context_tokens")) context_tokens = j["context_tokens"];
             if (j.contains("temperature")) temperature = j["temperature"];
             if (j.contains("top_p")) top_p = j["top_p"];
             if (j.contains("top_k")) top_k = j["top_k"];
@@ -145,15 +244,53 @@ void Settings::load(const std::string& path) {
             if (j.contains("suppress_blank")) suppress_blank = j["suppress_blank"];
             if (j.contains("suppress_non_speech_tokens")) suppress_non_speech_tokens = j["suppress_non_speech_tokens"];
             
+            // Load decoding strategy
+            if (j.contains("decode_preset")) decode_preset = j["decode_preset"];
+            if (j.contains("sampling_strategy")) sampling_strategy = j["sampling_strategy"];
+            if (j.contains("beam_size")) beam_size = j["beam_size"];
+            if (j.contains("best_of")) best_of = j["best_of"];
+            if (j.contains("temperature_inc")) temperature_inc = j["temperature_inc"];
+            if (j.contains("single_segment")) single_segment = j["single_segment"];
+            if (j.contains("no_timestamps")) no_timestamps = j["no_timestamps"];
+            
             // Load output settings
             if (j.contains("output_format")) output_format = j["output_format"];
             if (j.contains("output_file")) output_file = j["output_file"];
             if (j.contains("copy_to_clipboard")) copy_to_clipboard = j["copy_to_clipboard"];
+            if (j.contains("auto_paste")) auto_paste = j["auto_paste"];
+            
+            // Load streaming settings
+            if (j.contains("streaming_mode")) streaming_mode = j["streaming_mode"];
+            if (j.contains("stream_step_ms")) stream_step_ms = j["stream_step_ms"];
+            if (j.contains("stream_window_ms")) stream_window_ms = j["stream_window_ms"];
+            if (j.contains("stream_keep_ms")) stream_keep_ms = j["stream_keep_ms"];
+            if (j.contains("speculative_decode")) speculative_decode = j["speculative_decode"];
+            if (j.contains("speculative_pause_ms")) speculative_pause_ms = j["speculative_pause_ms"];
+            if (j.contains("long_form")) long_form = j["long_form"];
+            if (j.contains("long_form_chunk_ms")) long_form_chunk_ms = j["long_form_chunk_ms"];
+            if (j.contains("long_form_overlap_ms")) long_form_overlap_ms = j["long_form_overlap_ms"];
+            
+            // Load cascade settings
+            if (j.contains("cascade_draft_model")) cascade_draft_model = j["cascade_draft_model"];
+            if (j.contains("cascade_logprob_threshold")) cascade_logprob_threshold = j["cascade_logprob_threshold"];
+            if (j.contains("cascade_entropy_threshold")) cascade_entropy_threshold = j["cascade_entropy_threshold"];
+            
+            // Load daemon settings
+            if (j.contains("daemon_socket")) daemon_socket = j["daemon_socket"];
+            if (j.contains("metrics_port")) metrics_port = j["metrics_port"];
+            if (j.contains("metrics_address")) metrics_address = j["metrics_address"];
+            
+            // Load result cache settings
+            if (j.contains("result_cache")) result_cache = j["result_cache"];
+            if (j.contains("cache_dir")) cache_dir = j["cache_dir"];
+            if (j.contains("cache_max_mb")) cache_max_mb = j["cache_max_mb"];
             
             // Load performance settings
             if (j.contains("use_gpu")) use_gpu = j["use_gpu"];
             if (j.contains("use_metal")) use_metal = j["use_metal"];
             if (j.contains("use_accelerate")) use_accelerate = j["use_accelerate"];
+            if (j.contains("pool_size")) pool_size = j["pool_size"];
+            if (j.contains("memory_budget_mb")) memory_budget_mb = j["memory_budget_mb"];
             
             // Load hotkey settings
             if (j.contains("enable_hotkeys")) enable_hotkeys = j["enable_hotkeys"];
@@ -166,7 +303,9 @@ void Settings::load(const std::string& path) {
             if (j.contains("enable_terminal_input")) enable_terminal_input = j["enable_terminal_input"];
             if (j.contains("enable_global_hotkeys")) enable_global_hotkeys = j["enable_global_hotkeys"];
             
-            std::cout << "Settings loaded from: " << expanded_path << std::endl;
+            if (!quiet) {
+                std::cout << "Settings loaded from: " << expanded_path << std::endl;
+            }
         }
     } catch (const std::exception& e) {
         std::cerr << "Failed to load settings: " << e.what() << std::endl;
@@ -179,23 +318,38 @@ void Settings::print_help() const {
     
     std::cout << "Model Settings:\n";
     std::cout << "  model_path: Path to Whisper model file\n";
-    std::cout << "  model_size: Model size (tiny, base, small, medium, large)\n\n";
+    std::cout << "  model_size: Model size (tiny, base, small, medium, large), or auto to choose among benchmarked local models\n";
+    std::cout << "  model_latency_target_ms: With model_size auto, use the most accurate model decoding 10s of audio within this\n\n";
     
     std::cout << "Audio Settings:\n";
     std::cout << "  silence_duration: Duration of silence to stop recording (seconds)\n";
     std::cout << "  max_duration: Maximum recording duration (seconds)\n";
-    std::cout << "  silence_threshold: Audio threshold for silence detection\n";
-    std::cout << "  sample_rate: Audio sample rate (Hz)\n\n";
+    std::cout << "  silence_threshold: Minimum RMS level counted as speech (peak amplitude in 'peak' VAD mode)\n";
+    std::cout << "  sample_rate: Pipeline sample rate (Hz) - the device's native rate is resampled to this\n";
+    std::cout << "  audio_input: Read audio from \"-\" (stdin), a FIFO or a Unix socket instead of the microphone\n";
+    std::cout << "  raw_sample_rate: Sample rate of headerless s16le input (Hz)\n";
+    std::cout << "  raw_channels: Channel count of headerless s16le input\n";
+    std::cout << "  input_device: Capture device - index or part of the name from --list-devices (empty for default)\n";
+    std::cout << "  frames_per_buffer: Capture callback size in device-rate frames (0 for 32 ms)\n";
+    std::cout << "  input_latency_ms: Suggested input latency (milliseconds, 0 for the device's low-latency default)\n";
+    std::cout << "  always_armed: Keep the microphone stream open between recordings so starting one is instant\n";
+    std::cout << "  preroll_ms: With always_armed, audio from just before the start key that begins the recording\n\n";
+    
+    std::cout << "Voice Activity Detection Settings:\n";
+    std::cout << "  vad_mode: Detector (energy = energy + zero-crossing rate, silero, peak = legacy max amplitude)\n";
+    std::cout << "  vad_model_path: Silero VAD model for vad_mode 'silero'\n";
+    std::cout << "  vad_hangover_ms: Keep speech active this long after the last voiced frame (milliseconds)\n";
+    std::cout << "  vad_speech_pad_ms: Padding kept around each speech region (milliseconds)\n";
+    std::cout << "  vad_trim_silence: Skip non-speech audio before transcription\n\n";
     
     std::cout << "Whisper Settings:\n";
     std::cout << "  language: Language code or 'auto' for detection\n";
     std::cout << "  translate_to_english: Translate output to English\n";
     std::cout << "  num_threads: Number of CPU threads to use\n";
     std::cout << "  max_tokens: Maximum tokens in output\n";
+    std::cout << "  context_tokens: Tokens of earlier dictation passed as the decoder prompt (0 = decode every utterance cold)\n";
     std::cout << "  temperature: Sampling temperature (0.0 = deterministic)\n";
-    std::cout << "  top_p: Nucleus sampling parameter\n";
-    std::cout << "  top_k: Top-k sampling parameter\n";
-    std::cout << "  repetition_penalty: Penalty for repetition\n";
+    std::cout << "  top_p, top_k, repetition_penalty: Not supported by whisper.cpp (kept for compatibility, no effect)\n";
     std::cout << "  print_timestamps: Include timestamps in output\n";
     std::cout << "  print_colors: Use colored output\n";
     std::cout << "  print_special: Include special tokens\n";
@@ -207,15 +361,55 @@ void Settings::print_help() const {
     std::cout << "  suppress_blank: Suppress blank tokens\n";
     std::cout << "  suppress_non_speech_tokens: Suppress non-speech tokens\n\n";
     
+    std::cout << "Decoding Strategy:\n";
+    std::cout << "  decode_preset: interactive (one greedy pass, no fallback, no timestamp tokens), accurate (beam search\n";
+    std::cout << "                 of 5 with temperature fallback), auto (interactive for live audio, accurate for files),\n";
+    std::cout << "                 or custom to use the settings below as they are\n";
+    std::cout << "  sampling_strategy: greedy or beam_search\n";
+    std::cout << "  beam_size: Hypotheses kept by beam_search\n";
+    std::cout << "  best_of: Candidates sampled at each fallback temperature\n";
+    std::cout << "  temperature_inc: Retry at a higher temperature when a decode fails the thresholds (0 = never)\n";
+    std::cout << "  single_segment: Return one segment per 30s window\n";
+    std::cout << "  no_timestamps: Skip timestamp tokens (faster; segments span their whole window)\n\n";
+    
     std::cout << "Output Settings:\n";
     std::cout << "  output_format: Output format (text, json, srt, vtt, csv)\n";
     std::cout << "  output_file: Output file path (empty for stdout)\n";
-    std::cout << "  copy_to_clipboard: Copy result to clipboard\n\n";
+    std::cout << "  copy_to_clipboard: Copy result to clipboard\n";
+    std::cout << "  auto_paste: Paste the result into the focused application (needs accessibility permission on macOS)\n\n";
+    
+    std::cout << "Streaming Settings:\n";
+    std::cout << "  streaming_mode: Transcribe while recording, only the tail is decoded on stop\n";
+    std::cout << "  stream_step_ms: Interval between background decodes (milliseconds)\n";
+    std::cout << "  stream_window_ms: Maximum unconfirmed audio before segments are force-committed (milliseconds)\n";
+    std::cout << "  stream_keep_ms: Segments ending within this margin of the window edge stay unconfirmed (milliseconds)\n";
+    std::cout << "  speculative_decode: Decode each stretch of speech in the background as soon as you pause\n";
+    std::cout << "  speculative_pause_ms: Silence that closes a stretch of speech for speculative decoding (milliseconds)\n";
+    std::cout << "  long_form: Record until stopped (no max_duration or silence stop), decoding fixed chunks as they fill\n";
+    std::cout << "  long_form_chunk_ms: Audio per long-form decode (milliseconds)\n";
+    std::cout << "  long_form_overlap_ms: End of each chunk decoded again with the next one, so no word is cut (milliseconds)\n\n";
+    
+    std::cout << "Cascade Settings:\n";
+    std::cout << "  cascade_draft_model: Fast model that decodes first; model_path is loaded on demand to redo unsure segments\n";
+    std::cout << "  cascade_logprob_threshold: Re-decode segments whose average token log probability is below this\n";
+    std::cout << "  cascade_entropy_threshold: Re-decode segments whose token entropy is below this (repetition)\n\n";
+    
+    std::cout << "Daemon Settings:\n";
+    std::cout << "  daemon_socket: Unix socket the --daemon server listens on and --client connects to\n";
+    std::cout << "  metrics_port: Serve counters and latency histograms for Prometheus at /metrics on this TCP port (0 = off)\n";
+    std::cout << "  metrics_address: Address the metrics endpoint binds to (0.0.0.0 for remote scrapers)\n\n";
+    
+    std::cout << "Result Cache Settings:\n";
+    std::cout << "  result_cache: Reuse the transcript of audio already decoded with the same model and settings (daemon, batch)\n";
+    std::cout << "  cache_dir: Directory holding one entry per cached transcript\n";
+    std::cout << "  cache_max_mb: Evict least recently used entries once the cache grows past this\n\n";
     
     std::cout << "Performance Settings:\n";
     std::cout << "  use_gpu: Enable GPU acceleration\n";
     std::cout << "  use_metal: Enable Metal GPU on macOS\n";
-    std::cout << "  use_accelerate: Enable Accelerate framework\n\n";
+    std::cout << "  use_accelerate: Enable Accelerate framework\n";
+    std::cout << "  pool_size: Concurrent decode contexts sharing one model - each gets num_threads / pool_size threads\n";
+    std::cout << "  memory_budget_mb: Fail to start if weights + KV cache + compute buffers exceed this (0 = no limit)\n\n";
     
     std::cout << "Hotkey Settings:\n";
     std::cout << "  enable_hotkeys: Enable global hotkey support\n";
@@ -228,14 +422,43 @@ void Settings::print_current_settings() const {
     std::cout << "Current Settings:\n";
     std::cout << "================\n";
     
-    std::cout << "Model: " << model_path << " (" << model_size << ")\n";
+    std::cout << "Model: " << model_path << " (" << model_size
+              << (model_size == "auto" ? ", " + std::to_string(model_latency_target_ms) + "ms target" : "") << ")\n";
+    if (!cascade_draft_model.empty()) {
+        std::cout << "Cascade: " << cascade_draft_model << " drafts (LogProb<" << cascade_logprob_threshold
+                  << ", Entropy<" << cascade_entropy_threshold << " re-decoded)\n";
+    }
     std::cout << "Audio: " << sample_rate << "Hz, " << max_duration << "s max, " 
-              << silence_threshold << " threshold\n";
+              << silence_threshold << " threshold"
+              << (audio_input.empty() ? "" : ", input " + (audio_input == "-" ? std::string("stdin") : audio_input))
+              << (input_device.empty() ? "" : ", device " + input_device)
+              << (always_armed ? ", armed (" + std::to_string(preroll_ms) + "ms pre-roll)" : "") << "\n";
+    std::cout << "VAD: " << vad_mode << (vad_trim_silence ? " (trimming silence)" : "") << "\n";
     std::cout << "Language: " << language << (translate_to_english ? " → English" : "") << "\n";
-    std::cout << "Threads: " << num_threads << ", Temperature: " << temperature << "\n";
-    std::cout << "Top-p: " << top_p << ", Top-k: " << top_k << ", Repetition Penalty: " << repetition_penalty << "\n";
+    std::cout << "Threads: " << num_threads << " (pool of " << pool_size << "), Temperature: " << temperature << "\n";
+    std::cout << "Context carry-over: " << (context_tokens > 0 ? std::to_string(context_tokens) + " tokens" : "off") << "\n";
+    std::cout << "Memory budget: " << (memory_budget_mb > 0 ? std::to_string(memory_budget_mb) + " MB" : "none") << "\n";
+    std::cout << "Decoding: " << decode_preset;
+    if (decode_preset == "custom") {
+        std::cout << " (" << sampling_strategy << ", "
+                  << (sampling_strategy == "beam_search" ? "beam " + std::to_string(beam_size) : "best of " + std::to_string(best_of))
+                  << ", fallback +" << temperature_inc << (no_timestamps ? ", no timestamps" : "") << ")";
+    }
+    std::cout << "\n";
     std::cout << "Thresholds: Entropy=" << entropy_threshold << ", LogProb=" << logprob_threshold << ", NoSpeech=" << no_speech_threshold << "\n";
     std::cout << "Output: " << output_format << (output_file.empty() ? " (stdout)" : " → " + output_file) << "\n";
+    std::cout << "Streaming: " << (long_form || speculative_decode || streaming_mode ? "Yes" : "No");
+    if (long_form) {
+        std::cout << " (long-form, " << long_form_chunk_ms << "ms chunks, " << long_form_overlap_ms << "ms overlap)";
+    } else if (speculative_decode) {
+        std::cout << " (speculative, " << speculative_pause_ms << "ms pauses)";
+    } else if (streaming_mode) {
+        std::cout << " (step " << stream_step_ms << "ms, window " << stream_window_ms << "ms)";
+    }
+    std::cout << "\n";
+    std::cout << "Daemon socket: " << daemon_socket << "\n";
+    std::cout << "Metrics: " << (metrics_port > 0 ? metrics_address + ":" + std::to_string(metrics_port) : "off") << "\n";
+    std::cout << "Result cache: " << (result_cache ? cache_dir + " (" + std::to_string(cache_max_mb) + " MB)" : "off") << "\n";
     std::cout << "GPU: " << (use_gpu ? "Yes" : "No") << ", Metal: " << (use_metal ? "Yes" : "No") << "\n";
     std::cout << "Hotkeys: " << (enable_hotkeys ? "Yes" : "No");
     if (enable_hotkeys) {
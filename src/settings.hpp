@@ -8,19 +8,36 @@ namespace SuperWhisper {
 struct Settings {
     // Model settings
     std::string model_path = "model/ggml-base.en-q5_1.bin";
-    std::string model_size = "base";
+    std::string model_size = "base";  // "auto": pick from --models bench results (model_path's directory)
+    int model_latency_target_ms = 1000;  // model_size "auto": decode budget for 10 s of audio
     
     // Audio settings
     float silence_duration = 1.0f;
     int max_duration = 30;
     float silence_threshold = 0.01f;
     int sample_rate = 16000;
+    std::string audio_input = "";    // "" = microphone, "-" = stdin, or a FIFO / Unix socket path
+    int raw_sample_rate = 16000;     // Headerless s16le input (a WAV header overrides both)
+    int raw_channels = 1;
+    std::string input_device = "";   // "" = default input, an index or part of a name (--list-devices)
+    int frames_per_buffer = 0;       // Capture callback size at the device rate (0 = 32 ms)
+    float input_latency_ms = 0.0f;   // Suggested input latency (0 = the device's low-latency default)
+    bool always_armed = false;       // Keep the capture stream open between recordings (instant start)
+    int preroll_ms = 300;            // Audio from before the start key kept at the front of an armed recording
+    
+    // Voice activity detection settings
+    std::string vad_mode = "energy";  // energy, silero, peak
+    std::string vad_model_path = "model/ggml-silero-v5.1.2.bin";
+    int vad_hangover_ms = 300;        // Keep speech active this long after the last voiced frame
+    int vad_speech_pad_ms = 200;      // Padding kept around each detected speech region
+    bool vad_trim_silence = true;     // Only send detected speech regions to Whisper
     
     // Whisper settings
     std::string language = "auto";
     bool translate_to_english = false;
     int num_threads = 4;
     int max_tokens = 448;
+    int context_tokens = 64;  // Committed text tokens carried into the next utterance's prompt (0 = none)
     float temperature = 0.0f;
     float top_p = 1.0f;
     float top_k = 40;
@@ -38,31 +55,76 @@ struct Settings {
     bool suppress_blank = true;
     bool suppress_non_speech_tokens = true;
     
+    // Decoding strategy - decode_preset rewrites the fields below unless it is "custom"
+    std::string decode_preset = "auto";       // auto (interactive live, accurate for files), interactive, accurate, custom
+    std::string sampling_strategy = "greedy"; // greedy, beam_search
+    int beam_size = 5;                // Hypotheses kept by beam_search
+    int best_of = 5;                  // Candidates sampled at each fallback temperature (greedy)
+    float temperature_inc = 0.2f;     // Retry at temperature + inc when a decode fails the thresholds (0 = never)
+    bool single_segment = false;      // One segment per 30 s window
+    bool no_timestamps = false;       // Skip timestamp tokens (each segment then spans its window)
+    
     // Output settings
     std::string output_format = "text"; // text, json, srt, vtt, csv
     std::string output_file = "";
     bool copy_to_clipboard = true;
+    bool auto_paste = false;          // Paste into the focused app after copying (Cmd+V / Ctrl+V)
+    
+    // Streaming settings
+    bool streaming_mode = false;     // Decode overlapping windows while recording
+    int stream_step_ms = 1000;       // Interval between background decodes
+    int stream_window_ms = 20000;    // Force-commit once the unconfirmed window grows this long
+    int stream_keep_ms = 500;        // Segments ending this close to the window edge stay unconfirmed
+    bool speculative_decode = false; // Decode each stretch of speech in the background once the speaker pauses
+    int speculative_pause_ms = 300;  // Silence that closes a stretch of speech for speculative decoding
+    bool long_form = false;          // Meetings/lectures: no duration cap or silence stop, decoded in chunks
+    int long_form_chunk_ms = 30000;  // Audio per long-form decode
+    int long_form_overlap_ms = 5000; // Chunk tail decoded again at the start of the next chunk
+    
+    // Cascade settings: a small draft model decodes first, model_path re-decodes low-confidence segments
+    std::string cascade_draft_model = "";     // e.g. model/ggml-tiny.en-q5_1.bin (empty: cascade off)
+    float cascade_logprob_threshold = -0.8f;  // Escalate segments with a lower average token log probability
+    float cascade_entropy_threshold = 2.4f;   // ... or a lower token entropy (repetition loops)
+    
+    // Daemon settings
+    std::string daemon_socket = "~/.superwhisper/daemon.sock";  // Unix socket for --daemon / --client
+    int metrics_port = 0;  // Serve Prometheus metrics at http://metrics_address:PORT/metrics (0 = off)
+    std::string metrics_address = "127.0.0.1";
+    
+    // Result cache settings (daemon and batch): identical audio + decode settings skip the model
+    bool result_cache = true;
+    std::string cache_dir = "~/.superwhisper/cache";
+    int cache_max_mb = 256;          // Least recently used entries are evicted above this
     
     // Performance settings
     bool use_gpu = true;
     bool use_metal = true;
     bool use_accelerate = true;
+    int pool_size = 1;  // Concurrent decode contexts sharing one model (daemon, batch jobs)
+    int memory_budget_mb = 0;  // Refuse to run a model needing more than this (0 = no limit)
     
     // Hotkey settings
-    bool enable_hotkeys;
-    std::string start_hotkey;
-    std::string stop_hotkey;
-    std::string quit_hotkey;
+    bool enable_hotkeys = false;
+    std::string start_hotkey = "F9";
+    std::string stop_hotkey = "F10";
+    std::string quit_hotkey = "F12";
     
     // Input mode settings
-    std::string input_mode; // "terminal", "global", "both"
-    bool enable_terminal_input;  // Enable r, s, q keys in terminal
-    bool enable_global_hotkeys;  // Enable F9, F10, F12 global hotkeys
+    std::string input_mode = "terminal"; // "terminal", "global", "both"
+    bool enable_terminal_input = true;   // Enable r, s, q keys in terminal
+    bool enable_global_hotkeys = false;  // Enable F9, F10, F12 global hotkeys
     
     void save(const std::string& path);
-    void load(const std::string& path);
+    void load(const std::string& path, bool quiet = false);  // quiet: no status output (client mode)
     void print_help() const;
     void print_current_settings() const;
 };
 
+// Resolve decode_preset into the decoding fields for a live capture or a file workload.
+// Streaming, long-form and timed output formats always keep real segment timestamps.
+void apply_decode_preset(Settings& settings, bool live);
+
+// Expand a leading '~' to the home directory
+std::string expand_home(const std::string& path);
+
 } // namespace SuperWhisper
@@ -0,0 +1,424 @@
+#include "audio_recorder.hpp"
+#include "settings.hpp"
+#include "audio_dsp.hpp"
+#include "event_loop.hpp"
+#include "resampler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace SuperWhisper {
+
+namespace {
+
+uint16_t read_u16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t read_u32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// Open audio_input: "-" is stdin, a Unix socket path is connected to, anything else
+// (a FIFO or a file) is opened for reading. Returns -1 and prints why on failure.
+int open_input(const std::string& input) {
+    if (input == "-") {
+        return STDIN_FILENO;
+    }
+
+    struct stat info;
+    if (stat(input.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        sockaddr_un address{};
+        if (input.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Socket path too long: " << input << std::endl;
+            return -1;
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, input.c_str(), input.size() + 1);
+
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0) {
+            return fd;
+        }
+        std::cerr << "Failed to connect to " << input << ": " << std::strerror(errno) << std::endl;
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+
+    // Opening a FIFO blocks until the writer side is opened
+    const int fd = open(input.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Failed to open " << input << ": " << std::strerror(errno) << std::endl;
+    }
+    return fd;
+}
+
+} // namespace
+
+// Audio from a byte stream (stdin, a FIFO or a Unix socket) instead of a device:
+// a WAV stream (16-bit PCM or 32-bit float, any rate and channel count, the data
+// size is ignored) or headerless s16le at raw_sample_rate/raw_channels. A reader
+// thread does large reads and delivers the audio in device-sized chunks through the
+// same callback and ring as a microphone.
+//
+// The source is not live: it is read as fast as it arrives, nothing is read while
+// stopped (the writer blocks instead of audio being dropped), and whatever was read
+// past a stop is delivered first when recording starts again. Calling stop() from
+// the audio callback ends the recording exactly at that chunk.
+class StreamAudioRecorder : public AudioRecorder {
+public:
+    StreamAudioRecorder(int fd, const Settings& settings)
+        : fd_(fd), output_rate_(settings.sample_rate), raw_rate_(settings.raw_sample_rate),
+          raw_channels_(std::max(1, settings.raw_channels)),
+          max_buffer_samples_(static_cast<size_t>(settings.sample_rate) * kMaxBufferSeconds),
+          ring_(max_buffer_samples_), start_pos_(0), read_buffer_(kReadBytes) {}
+
+    ~StreamAudioRecorder() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closing_ = true;
+        }
+        resume_.notify_all();
+        wake_.notify();
+        if (reader_.joinable()) {
+            reader_.join();
+        }
+        if (fd_ != STDIN_FILENO) {
+            close(fd_);
+        }
+    }
+
+    bool start() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (recording_) return false;
+
+        if (!reader_.joinable()) {
+            reader_ = std::thread([this]() { reader_loop(); });
+        }
+        recording_ = true;
+        resume_.notify_all();
+        return true;
+    }
+
+    void stop() override {
+        // From the audio callback (which runs under the lock) the stop is exact: the
+        // rest of the stream stays pending for the next recording
+        if (std::this_thread::get_id() == reader_.get_id()) {
+            recording_ = false;
+            return;
+        }
+
+        // Once this returns nothing more is written to the ring
+        std::lock_guard<std::mutex> lock(mutex_);
+        recording_ = false;
+    }
+
+    bool is_recording() const override {
+        return recording_;
+    }
+
+    AudioBuffer get_audio() const override {
+        AudioView view = get_audio_view();
+        AudioBuffer audio(view.size());
+        view.copy_to(audio.data());
+        return audio;
+    }
+
+    AudioView get_audio_view() const override {
+        return ring_.view(start_pos_.load(std::memory_order_acquire), max_buffer_samples_);
+    }
+
+    bool has_audio() const override {
+        return ring_.write_position() > start_pos_.load(std::memory_order_acquire);
+    }
+
+    void clear() override {
+        start_pos_.store(ring_.write_position(), std::memory_order_release);
+    }
+
+    void set_audio_callback(std::function<void(const AudioSample*, size_t)> callback) override {
+        callback_ = callback;
+    }
+
+    int sample_rate() const override {
+        return output_rate_;
+    }
+
+    bool is_live() const override {
+        return false;
+    }
+
+    bool at_end() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return end_of_input_ && pending_pos_ == pending_.size();
+    }
+
+    void set_end_callback(std::function<void()> callback) override {
+        end_callback_ = callback;
+    }
+
+private:
+    void reader_loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        while (!closing_) {
+            resume_.wait(lock, [this]() { return recording_ || closing_; });
+            if (closing_) break;
+
+            // Audio read past the last stop belongs to this recording
+            deliver_pending();
+            if (!recording_) continue;
+
+            if (end_of_input_) {
+                if (!end_reported_) {
+                    end_reported_ = true;
+                    if (end_callback_) end_callback_();
+                }
+                resume_.wait(lock, [this]() { return !recording_ || closing_; });
+                continue;
+            }
+
+            lock.unlock();
+            ssize_t n = -1;
+            const bool readable = wake_.wait(fd_, std::nullopt);
+            if (readable) {
+                n = read(fd_, read_buffer_.data(), read_buffer_.size());
+            }
+            lock.lock();
+
+            if (!readable || (n < 0 && (errno == EINTR || errno == EAGAIN))) {
+                continue;
+            }
+            if (n < 0) {
+                std::cerr << "Audio input read failed: " << std::strerror(errno) << std::endl;
+            }
+            if (n <= 0) {
+                finish_input();
+                continue;
+            }
+
+            bytes_.insert(bytes_.end(), read_buffer_.begin(), read_buffer_.begin() + n);
+            if (!decode_bytes()) {
+                finish_input();
+            }
+        }
+    }
+
+    // Push pending audio through the callback and ring in chunks while recording
+    // (called with mutex_ held, so stop() waits for the chunk in flight)
+    void deliver_pending() {
+        while (recording_ && pending_pos_ < pending_.size()) {
+            const size_t available = pending_.size() - pending_pos_;
+            if (available < kChunkSamples && !end_of_input_) break;
+
+            const size_t count = std::min(available, kChunkSamples);
+            const AudioSample* chunk = pending_.data() + pending_pos_;
+            if (callback_) {
+                callback_(chunk, count);
+            }
+            ring_.write(chunk, count);
+            pending_pos_ += count;
+        }
+
+        // Keep the partial chunk at the front for the next read
+        if (pending_pos_ > 0) {
+            pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(pending_pos_));
+            pending_pos_ = 0;
+        }
+    }
+
+    // Parse the WAV header if there is one, then convert every whole frame in bytes_
+    // to output-rate samples in pending_. False if the stream cannot be decoded.
+    bool decode_bytes() {
+        if (!format_known_) {
+            if (bytes_.size() < 12) return true;
+            if (std::memcmp(bytes_.data(), "RIFF", 4) != 0) {
+                // Headerless s16le
+                set_format(1, raw_channels_, raw_rate_, 16);
+            } else if (!parse_wav_header()) {
+                if (format_error_) return false;
+                return bytes_.size() < kMaxHeaderBytes || fail("no WAV data chunk in the first 64 KB");
+            }
+            bytes_.erase(bytes_.begin(), bytes_.begin() + static_cast<std::ptrdiff_t>(header_bytes_));
+        }
+
+        const size_t frame_bytes = static_cast<size_t>(channels_) * (bits_ / 8);
+        const size_t frames = bytes_.size() / frame_bytes;
+        if (frames == 0) return true;
+
+        mono_.resize(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            const uint8_t* frame = bytes_.data() + i * frame_bytes;
+            float sum = 0.0f;
+            for (int c = 0; c < channels_; ++c) {
+                if (format_ == 3) {
+                    float value;
+                    std::memcpy(&value, frame + c * 4, sizeof(value));
+                    sum += value;
+                } else {
+                    sum += static_cast<int16_t>(read_u16(frame + c * 2)) / 32768.0f;
+                }
+            }
+            mono_[i] = sum / channels_;
+        }
+        bytes_.erase(bytes_.begin(), bytes_.begin() + static_cast<std::ptrdiff_t>(frames * frame_bytes));
+
+        if (resampler_) {
+            resampled_.resize(resampler_->max_output(frames));
+            append_pending(resampled_.data(), resampler_->process(mono_.data(), frames, resampled_.data()));
+        } else {
+            append_pending(mono_.data(), frames);
+        }
+        return true;
+    }
+
+    // Walk the RIFF chunks up to "data". False while more header bytes are needed
+    // or, with format_error_ set, if the encoding is not supported.
+    bool parse_wav_header() {
+        int format = 0, channels = 0, rate = 0, bits = 0;
+
+        for (size_t pos = 12; pos + 8 <= bytes_.size();) {
+            const uint8_t* chunk = bytes_.data() + pos;
+            const size_t chunk_size = read_u32(chunk + 4);
+
+            if (std::memcmp(chunk, "data", 4) == 0) {
+                // Streamed WAVs (ffmpeg to a pipe) carry a placeholder size: read to EOF
+                header_bytes_ = pos + 8;
+                const bool supported = channels > 0 && rate > 0 &&
+                                       ((format == 1 && bits == 16) || (format == 3 && bits == 32));
+                if (!supported) {
+                    format_error_ = true;
+                    return fail("unsupported WAV stream (format " + std::to_string(format) + ", " +
+                                std::to_string(bits) + " bits); use 16-bit PCM or 32-bit float");
+                }
+                set_format(format, channels, rate, bits);
+                return true;
+            }
+
+            if (pos + 8 + chunk_size + (chunk_size & 1) > bytes_.size()) break;
+            if (std::memcmp(chunk, "fmt ", 4) == 0 && chunk_size >= 16) {
+                format = read_u16(chunk + 8);
+                channels = read_u16(chunk + 10);
+                rate = static_cast<int>(read_u32(chunk + 12));
+                bits = read_u16(chunk + 22);
+                // WAVE_FORMAT_EXTENSIBLE stores the real format in the sub-format GUID
+                if (format == 0xFFFE && chunk_size >= 26) {
+                    format = read_u16(chunk + 32);
+                }
+            }
+            pos += 8 + chunk_size + (chunk_size & 1);
+        }
+        return false;
+    }
+
+    void set_format(int format, int channels, int rate, int bits) {
+        format_ = format;
+        channels_ = channels;
+        bits_ = bits;
+        format_known_ = true;
+        if (rate != output_rate_) {
+            resampler_ = std::make_unique<PolyphaseResampler>(rate, output_rate_);
+        }
+        std::cerr << "Audio input: " << rate << " Hz, " << channels << " channel(s), "
+                  << (format == 3 ? "float32" : "s16le") << std::endl;
+    }
+
+    bool fail(const std::string& error) {
+        std::cerr << "Audio input: " << error << std::endl;
+        return false;
+    }
+
+    void append_pending(const float* samples, size_t count) {
+        const size_t offset = pending_.size();
+        pending_.resize(offset + count);
+        for (size_t i = 0; i < count; ++i) {
+            const float scaled = std::clamp(samples[i] * 32768.0f, -32768.0f, 32767.0f);
+            pending_[offset + i] = static_cast<AudioSample>(std::lrint(scaled));
+        }
+    }
+
+    void finish_input() {
+        if (resampler_) {
+            resampled_.resize(resampler_->max_output(kResamplerTaps));
+            append_pending(resampled_.data(), resampler_->flush(resampled_.data()));
+        }
+        end_of_input_ = true;
+    }
+
+    // Same 30 s window as a device recording
+    static constexpr size_t kMaxBufferSeconds = 30;
+
+    // Chunk size handed to the callback: 512 frames, a microphone's callback period
+    static constexpr size_t kChunkSamples = 512;
+
+    // Bytes per read(): one syscall for ~2 s of 16 kHz s16le
+    static constexpr size_t kReadBytes = 64 * 1024;
+
+    // Give up on a WAV header that has no data chunk within this many bytes
+    static constexpr size_t kMaxHeaderBytes = 64 * 1024;
+
+    // PolyphaseResampler's default filter length (flush() output bound)
+    static constexpr size_t kResamplerTaps = 64;
+
+    const int fd_;
+    const int output_rate_;
+    const int raw_rate_;
+    const int raw_channels_;
+
+    std::function<void(const AudioSample*, size_t)> callback_;
+    std::function<void()> end_callback_;
+
+    // Capture buffer, same layout as the device recorder
+    const size_t max_buffer_samples_;
+    SpscRingBuffer<AudioSample> ring_;
+    std::atomic<uint64_t> start_pos_;
+
+    // Reader thread state (guarded by mutex_)
+    mutable std::mutex mutex_;
+    std::condition_variable resume_;
+    std::thread reader_;
+    EventLoop wake_;  // Interrupts the blocking wait for input on shutdown
+    std::atomic<bool> recording_{false};
+    bool closing_ = false;
+    bool end_of_input_ = false;
+    bool end_reported_ = false;
+
+    // Stream decoding
+    std::vector<uint8_t> read_buffer_;
+    std::vector<uint8_t> bytes_;       // Undecoded bytes (header, partial frames)
+    bool format_known_ = false;
+    bool format_error_ = false;
+    size_t header_bytes_ = 0;
+    int format_ = 1;
+    int channels_ = 1;
+    int bits_ = 16;
+    std::unique_ptr<PolyphaseResampler> resampler_;
+    std::vector<float> mono_;
+    std::vector<float> resampled_;
+    AudioBuffer pending_;              // Decoded, not yet delivered
+    size_t pending_pos_ = 0;
+};
+
+std::unique_ptr<AudioRecorder> create_stream_recorder(const Settings& settings) {
+    const int fd = open_input(settings.audio_input);
+    if (fd < 0) {
+        return nullptr;
+    }
+    return std::make_unique<StreamAudioRecorder>(fd, settings);
+}
+
+} // namespace SuperWhisper
@@ -0,0 +1,404 @@
+#include "streaming_transcriber.hpp"
+#include "settings.hpp"
+#include "vad.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+namespace SuperWhisper {
+
+// Capture ring, background worker and commit bookkeeping shared by all strategies.
+// Subclasses decide in decode_step() what part of the uncommitted audio to commit.
+class BackgroundTranscriber : public StreamingTranscriber {
+public:
+    BackgroundTranscriber(WhisperWrapper& whisper, const Settings& settings, int step_ms, size_t ring_samples)
+        : whisper_(whisper), settings_(settings), step_(step_ms), ring_(ring_samples) {
+        // Background decodes run every step - keep whisper.cpp quiet
+        settings_.print_progress = false;
+    }
+
+    ~BackgroundTranscriber() override {
+        cancel();
+    }
+
+    void start() override {
+        cancel();
+
+        // The ring is never cleared - the utterance simply starts at the current position
+        base_pos_ = ring_.write_position();
+        committed_pos_ = base_pos_;
+        released_pos_ = base_pos_;
+        committed_.clear();
+        reset_state();
+
+        running_ = true;
+        worker_ = std::thread([this]() { worker_loop(); });
+    }
+
+    void push_audio(const AudioSample* data, size_t count) override {
+        if (!running_) return;
+
+        // A piped source can wait for the decoder instead of overwriting undecoded audio
+        if (producer_waits_) {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            room_.wait(lock, [&]() {
+                return !running_ || ring_.write_position() + count <= released_pos_ + ring_.capacity();
+            });
+        }
+
+        // Wait-free hand-off from the audio thread
+        ring_.write(data, count);
+    }
+
+    TranscriptSegments finish() override {
+        stop_worker();
+
+        // Only the unconfirmed tail is left to decode
+        const AudioView view = ring_.view(committed_pos_);
+        if (!view.empty()) {
+            TranscriptSegments segments = decode(view);
+            commit(segments, segments.size(), view.end());
+        }
+        reset_state();
+
+        return std::move(committed_);
+    }
+
+    void cancel() override {
+        stop_worker();
+    }
+
+    bool is_active() const override {
+        return running_;
+    }
+
+    // Only between utterances: the worker reads it without a lock
+    void set_segment_callback(SegmentCallback callback) override {
+        stop_worker();
+        segment_callback_ = std::move(callback);
+    }
+
+    void set_producer_waits(bool wait) override {
+        stop_worker();
+        producer_waits_ = wait;
+    }
+
+protected:
+    // One background step over the uncommitted audio, on the worker thread
+    virtual void decode_step() = 0;
+
+    // Forget per-utterance state
+    virtual void reset_state() = 0;
+
+    // Decode straight out of the ring (the producer only appends past the view), with
+    // timestamps shifted from the view's start to the start of the utterance
+    TranscriptSegments decode(const AudioView& view) {
+        TranscriptSegments segments = whisper_.transcribe_segments(view, settings_.sample_rate, settings_);
+
+        const int64_t offset_ms = position_to_ms(view.start);
+        for (auto& segment : segments) {
+            segment.start_ms += offset_ms;
+            segment.end_ms += offset_ms;
+        }
+        return segments;
+    }
+
+    // Commit segments[0, count) and everything before ring position `end_pos`.
+    // Committed text prompts the following decodes and is handed to the segment callback.
+    void commit(TranscriptSegments& segments, size_t count, uint64_t end_pos) {
+        for (size_t i = 0; i < count; ++i) {
+            whisper_.commit_context(segments[i].text);
+            if (segment_callback_) segment_callback_(segments[i]);
+        }
+        committed_.insert(committed_.end(),
+                          std::make_move_iterator(segments.begin()),
+                          std::make_move_iterator(segments.begin() + count));
+        committed_pos_ = std::max(committed_pos_, end_pos);
+    }
+
+    // Milliseconds since the start of the utterance for an absolute ring position
+    int64_t position_to_ms(uint64_t pos) const {
+        return static_cast<int64_t>(pos - base_pos_) * 1000 / settings_.sample_rate;
+    }
+
+    uint64_t ms_to_position(int64_t ms) const {
+        return base_pos_ + static_cast<uint64_t>(std::max<int64_t>(ms, 0)) * settings_.sample_rate / 1000;
+    }
+
+    WhisperWrapper& whisper_;
+    Settings settings_;
+    const std::chrono::milliseconds step_;
+
+    // Captured audio (producer: audio callback, consumer: decode worker)
+    SpscRingBuffer<AudioSample> ring_;
+
+    // Decode state - only touched by the worker thread, or by finish() after join
+    TranscriptSegments committed_;
+    uint64_t base_pos_ = 0;       // Ring position where the utterance started
+    uint64_t committed_pos_ = 0;  // Everything before this position is committed
+
+private:
+    void stop_worker() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            running_ = false;
+        }
+        wake_.notify_all();
+        room_.notify_all();
+
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+
+    void worker_loop() {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        while (running_) {
+            wake_.wait_for(lock, step_, [this]() { return !running_; });
+            if (!running_) break;
+
+            lock.unlock();
+            try {
+                decode_step();
+            } catch (const std::exception& e) {
+                std::cerr << "Streaming decode error: " << e.what() << std::endl;
+            }
+            lock.lock();
+
+            // Audio before the commit point may now be overwritten
+            released_pos_ = committed_pos_;
+            room_.notify_all();
+        }
+    }
+
+    SegmentCallback segment_callback_;
+    bool producer_waits_ = false;
+
+    // Background worker
+    std::atomic<bool> running_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::condition_variable room_;    // Signals a waiting producer after each step
+    uint64_t released_pos_ = 0;       // committed_pos_ as of the last step (guarded by wake_mutex_)
+    std::thread worker_;
+};
+
+// Windowed streaming transcriber using local agreement between consecutive decodes
+class WindowedStreamingTranscriber : public BackgroundTranscriber {
+public:
+    WindowedStreamingTranscriber(WhisperWrapper& whisper, const Settings& settings)
+        : BackgroundTranscriber(whisper, settings, settings.stream_step_ms,
+                                static_cast<size_t>(settings.max_duration) * settings.sample_rate) {}
+
+private:
+    static std::string_view trimmed(const std::string& text) {
+        const auto first = text.find_first_not_of(" \t\n");
+        if (first == std::string::npos) return {};
+        const auto last = text.find_last_not_of(" \t\n");
+        return std::string_view(text).substr(first, last - first + 1);
+    }
+
+    void reset_state() override {
+        decoded_pos_ = committed_pos_;
+        hypothesis_.clear();
+    }
+
+    void decode_step() override {
+        // Snapshot the unconfirmed region of the capture ring
+        const AudioView view = ring_.view(committed_pos_);
+        const uint64_t end_pos = view.end();
+
+        // Skip the decode if less than half a step of new audio arrived
+        const uint64_t min_new = static_cast<uint64_t>(settings_.stream_step_ms) * settings_.sample_rate / 2000;
+        if (end_pos < decoded_pos_ + min_new) return;
+        if (view.empty()) return;
+
+        decoded_pos_ = end_pos;
+        TranscriptSegments segments = decode(view);
+
+        const int64_t offset_ms = position_to_ms(view.start);
+        const int64_t window_end_ms = position_to_ms(end_pos);
+        const bool force_commit = (window_end_ms - offset_ms) >= settings_.stream_window_ms;
+
+        // Commit the longest prefix that agrees with the previous decode.
+        // The last segment is never committed - it may still be cut mid-word.
+        size_t n_commit = 0;
+        while (n_commit + 1 < segments.size()) {
+            const auto& segment = segments[n_commit];
+            if (segment.end_ms > window_end_ms - settings_.stream_keep_ms) break;
+
+            const bool agreed = n_commit < hypothesis_.size() &&
+                                trimmed(hypothesis_[n_commit].text) == trimmed(segment.text);
+            if (!agreed && !force_commit) break;
+
+            ++n_commit;
+        }
+
+        if (n_commit > 0) {
+            commit(segments, n_commit, std::min(ms_to_position(segments[n_commit - 1].end_ms), end_pos));
+        }
+
+        hypothesis_.assign(std::make_move_iterator(segments.begin() + n_commit),
+                           std::make_move_iterator(segments.end()));
+    }
+
+    TranscriptSegments hypothesis_;
+    uint64_t decoded_pos_ = 0;    // End of the last decoded window
+};
+
+// Speculative transcriber: as soon as the speaker pauses, the speech before the pause
+// is decoded (encoder and decoder) in the background and committed outright - a cut
+// in silence cannot split a word, so no second decode is needed to confirm it.
+// On stop only the audio after the last pause is still waiting for the encoder.
+class SpeculativeTranscriber : public BackgroundTranscriber {
+public:
+    SpeculativeTranscriber(WhisperWrapper& whisper, const Settings& settings)
+        : BackgroundTranscriber(whisper, settings, kPollMs,
+                                static_cast<size_t>(settings.max_duration) * settings.sample_rate),
+          vad_(create_vad(settings)),
+          pause_samples_(ms_to_samples(settings.speculative_pause_ms, settings.sample_rate)),
+          pad_samples_(ms_to_samples(settings.vad_speech_pad_ms, settings.sample_rate)) {}
+
+private:
+    void reset_state() override {
+        scanned_pos_ = committed_pos_;
+    }
+
+    void decode_step() override {
+        const AudioView view = ring_.view(committed_pos_);
+
+        // Re-run detection only once there is enough new audio for a pause to have closed
+        if (view.end() < scanned_pos_ + ms_to_samples(kPollMs, settings_.sample_rate)) return;
+        scanned_pos_ = view.end();
+        if (view.size() <= pause_samples_) return;
+
+        vad_->detect(view, settings_.sample_rate, regions_);
+        if (regions_.empty()) {
+            // Nothing but silence so far: drop it, keeping a pause worth in case speech starts now
+            committed_pos_ = view.end() - pause_samples_;
+            return;
+        }
+
+        // The last region followed by at least a pause. Regions come padded by
+        // vad_speech_pad_ms, so the silence is measured between the unpadded edges.
+        size_t cut = 0;
+        for (size_t i = 0; i < regions_.size(); ++i) {
+            const size_t speech_end = regions_[i].end - std::min(regions_[i].end, pad_samples_);
+            const size_t next_speech = i + 1 < regions_.size() ? regions_[i + 1].start + pad_samples_ : view.size();
+            if (next_speech >= speech_end + pause_samples_) cut = regions_[i].end;
+        }
+        if (cut == 0) return;  // Still talking
+
+        const AudioView closed = view.subview(0, cut);
+        TranscriptSegments segments = decode(closed);
+        commit(segments, segments.size(), closed.end());
+    }
+
+    static size_t ms_to_samples(int ms, int sample_rate) {
+        return static_cast<size_t>(std::max(ms, 0)) * sample_rate / 1000;
+    }
+
+    // Poll for closed regions often enough that a pause is noticed within ~100 ms
+    static constexpr int kPollMs = 100;
+
+    std::unique_ptr<VoiceActivityDetector> vad_;
+    const size_t pause_samples_;
+    const size_t pad_samples_;
+    SpeechRegions regions_;
+    uint64_t scanned_pos_ = 0;    // End of the audio the last detection looked at
+};
+
+// Long-form transcriber: the recording is cut into fixed chunks that are decoded as
+// soon as they are complete. Segments ending in the last long_form_overlap_ms of a
+// chunk may be cut mid-word, so they are dropped and the next chunk starts where the
+// last kept segment ends - the overlap is decoded again with the committed text as
+// prompt. Audio is held only in a ring of a few chunks, however long the session runs.
+class ChunkedTranscriber : public BackgroundTranscriber {
+public:
+    ChunkedTranscriber(WhisperWrapper& whisper, const Settings& settings)
+        : BackgroundTranscriber(whisper, settings, kPollMs, chunk_samples(settings) * kRingChunks),
+          chunk_samples_(chunk_samples(settings)),
+          overlap_samples_(std::min(ms_to_samples(settings.long_form_overlap_ms, settings.sample_rate), chunk_samples_ / 2)) {}
+
+private:
+    void reset_state() override {}
+
+    void decode_step() override {
+        AudioView view = ring_.view(committed_pos_);
+
+        // The ring only holds kRingChunks chunks: decoding slower than real time loses the oldest audio
+        if (view.start > committed_pos_) {
+            std::cerr << "Long-form decode fell behind, " << position_to_ms(view.start) - position_to_ms(committed_pos_)
+                      << " ms of audio dropped" << std::endl;
+            committed_pos_ = view.start;
+        }
+        if (view.size() < chunk_samples_) return;
+
+        const AudioView chunk = view.subview(0, chunk_samples_);
+        TranscriptSegments segments = decode(chunk);
+
+        // The producer may have lapped the ring during the decode, overwriting the start of
+        // the chunk under it: drop that text and resume at the oldest audio still held
+        if (!ring_.is_intact(chunk)) {
+            const uint64_t oldest = ring_.view(chunk.start).start;
+            std::cerr << "Long-form decode fell behind, " << position_to_ms(oldest) - position_to_ms(chunk.start)
+                      << " ms of audio overwritten while decoding, its text dropped" << std::endl;
+            committed_pos_ = oldest;
+            return;
+        }
+
+        // Keep what ends before the overlap; the rest is decoded again with the next chunk
+        const int64_t keep_end_ms = position_to_ms(chunk.end() - overlap_samples_);
+        size_t n_commit = 0;
+        while (n_commit < segments.size() && segments[n_commit].end_ms <= keep_end_ms) {
+            ++n_commit;
+        }
+
+        if (n_commit > 0) {
+            commit(segments, n_commit, std::min(ms_to_position(segments[n_commit - 1].end_ms), chunk.end()));
+        } else if (segments.empty()) {
+            // Silence: move on, keeping the overlap in case speech starts in it
+            commit(segments, 0, chunk.end() - overlap_samples_);
+        } else {
+            // The first segment already runs into the overlap - commit it rather than stall
+            commit(segments, 1, std::min(ms_to_position(segments[0].end_ms), chunk.end()));
+        }
+    }
+
+    static size_t ms_to_samples(int ms, int sample_rate) {
+        return static_cast<size_t>(std::max(ms, 0)) * sample_rate / 1000;
+    }
+
+    static size_t chunk_samples(const Settings& settings) {
+        return ms_to_samples(std::max(settings.long_form_chunk_ms, kMinChunkMs), settings.sample_rate);
+    }
+
+    // A full chunk is noticed within this long after it is captured
+    static constexpr int kPollMs = 250;
+
+    // Ring capacity in chunks: the one being decoded plus headroom for slow decodes
+    static constexpr size_t kRingChunks = 4;
+
+    static constexpr int kMinChunkMs = 5000;
+
+    const size_t chunk_samples_;
+    const size_t overlap_samples_;
+};
+
+// Factory function
+std::unique_ptr<StreamingTranscriber> create_streaming_transcriber(WhisperWrapper& whisper, const Settings& settings) {
+    if (settings.long_form) {
+        return std::make_unique<ChunkedTranscriber>(whisper, settings);
+    }
+    if (settings.speculative_decode) {
+        return std::make_unique<SpeculativeTranscriber>(whisper, settings);
+    }
+    return std::make_unique<WindowedStreamingTranscriber>(whisper, settings);
+}
+
+} // namespace SuperWhisper
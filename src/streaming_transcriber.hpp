@@ -0,0 +1,51 @@
+#pragma once
+
+#include "whisper_wrapper.hpp"
+#include <memory>
+
+namespace SuperWhisper {
+
+struct Settings;
+
+// Streaming transcriber interface
+// Decodes in the background while audio is being recorded and commits what is settled,
+// so on finish() only the short unconfirmed tail still has to be decoded. Three strategies:
+// - windowed (streaming_mode): overlapping windows, segments that stay identical across
+//   consecutive decodes are committed
+// - speculative (speculative_decode): each stretch of speech is decoded once, as soon as
+//   the speaker pauses for speculative_pause_ms
+// - long-form (long_form): fixed long_form_chunk_ms chunks overlapping by long_form_overlap_ms,
+//   for sessions of any length in a fixed-size ring
+// Segment timestamps always count from start().
+class StreamingTranscriber {
+public:
+    virtual ~StreamingTranscriber() = default;
+
+    // Begin a new utterance (spawns the background decode thread)
+    virtual void start() = 0;
+
+    // Feed captured audio - called from the audio callback, must stay cheap
+    virtual void push_audio(const AudioSample* data, size_t count) = 0;
+
+    // Stop background decoding, decode the unconfirmed tail and return all segments
+    virtual TranscriptSegments finish() = 0;
+
+    // Stop background decoding and discard everything
+    virtual void cancel() = 0;
+
+    virtual bool is_active() const = 0;
+
+    // Called with each segment once it is committed, from the decode worker (or from
+    // finish() for the tail) - lets the caller show text while recording goes on
+    virtual void set_segment_callback(SegmentCallback callback) = 0;
+
+    // For sources that are not real time (piped audio): push_audio() then blocks while
+    // the ring is full of audio the decoder has not committed, instead of dropping it
+    virtual void set_producer_waits(bool wait) = 0;
+};
+
+// Factory function for creating a streaming transcriber on top of a loaded model
+// (long-form if settings.long_form is set, else speculative if settings.speculative_decode, else windowed)
+std::unique_ptr<StreamingTranscriber> create_streaming_transcriber(WhisperWrapper& whisper, const Settings& settings);
+
+} // namespace SuperWhisper
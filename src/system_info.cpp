@@ -0,0 +1,61 @@
+#include "system_info.hpp"
+#include <algorithm>
+#include <thread>
+#include <sys/resource.h>
+
+#ifdef __APPLE__
+#include <mach/mach.h>
+#include <sys/sysctl.h>
+#else
+#include <cstdio>
+#include <unistd.h>
+#endif
+
+namespace SuperWhisper {
+
+size_t current_rss_bytes() {
+#ifdef __APPLE__
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+#else
+    // Second field of /proc/self/statm is the resident page count
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    long pages = 0, resident = 0;
+    const int fields = std::fscanf(statm, "%ld %ld", &pages, &resident);
+    std::fclose(statm);
+    return fields == 2 ? static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#endif
+}
+
+size_t peak_rss_bytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);         // Bytes on macOS
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;  // Kilobytes on Linux
+#endif
+}
+
+int performance_core_count() {
+#ifdef __APPLE__
+    // perflevel0 is the performance cluster on Apple Silicon; Intel Macs only have hw.physicalcpu
+    int cores = 0;
+    size_t size = sizeof(cores);
+    if (sysctlbyname("hw.perflevel0.physicalcpu", &cores, &size, nullptr, 0) == 0 && cores > 0) {
+        return cores;
+    }
+    size = sizeof(cores);
+    if (sysctlbyname("hw.physicalcpu", &cores, &size, nullptr, 0) == 0 && cores > 0) {
+        return cores;
+    }
+#endif
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+} // namespace SuperWhisper
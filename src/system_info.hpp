@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+namespace SuperWhisper {
+
+// Resident set size of this process right now, in bytes (0 if unavailable)
+size_t current_rss_bytes();
+
+// Highest resident set size reached by this process so far, in bytes
+size_t peak_rss_bytes();
+
+// Cores of the fastest kind: P-cores on Apple Silicon, every logical CPU elsewhere (at least 1)
+int performance_core_count();
+
+} // namespace SuperWhisper
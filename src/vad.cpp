@@ -0,0 +1,343 @@
+#include "vad.hpp"
+#include "settings.hpp"
+#include "audio_dsp.hpp"
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+#ifdef SUPERWHISPER_SILERO_VAD
+#include "whisper.h"
+#endif
+
+namespace SuperWhisper {
+
+namespace {
+
+// Analysis frame length and the largest frame we support (20 ms @ 48 kHz fits)
+constexpr int kFrameMs = 20;
+constexpr size_t kMaxFrameSamples = 1024;
+
+// Iterate over fixed-size frames of a two-span view; frames that straddle the
+// wrap-around point are gathered into a small local buffer
+template <typename Fn>
+void for_each_frame(const AudioView& audio, size_t frame_size, Fn&& fn) {
+    std::array<AudioSample, kMaxFrameSamples> gathered;
+    const size_t n_frames = audio.size() / frame_size;
+
+    for (size_t f = 0; f < n_frames; ++f) {
+        const size_t begin = f * frame_size;
+        const size_t end = begin + frame_size;
+
+        if (end <= audio.first.size()) {
+            fn(audio.first.data() + begin);
+        } else if (begin >= audio.first.size()) {
+            fn(audio.second.data() + (begin - audio.first.size()));
+        } else {
+            const size_t head = audio.first.size() - begin;
+            std::copy(audio.first.begin() + begin, audio.first.end(), gathered.begin());
+            std::copy(audio.second.begin(), audio.second.begin() + (frame_size - head), gathered.begin() + head);
+            fn(gathered.data());
+        }
+    }
+}
+
+// Pad regions and merge the ones that end up touching (in place - the merged
+// count never overtakes the read position)
+void pad_and_merge(SpeechRegions& regions, size_t pad, size_t total) {
+    size_t merged = 0;
+
+    for (const auto& region : regions) {
+        SpeechRegion padded{region.start > pad ? region.start - pad : 0, std::min(region.end + pad, total)};
+        if (merged > 0 && padded.start <= regions[merged - 1].end) {
+            regions[merged - 1].end = std::max(regions[merged - 1].end, padded.end);
+        } else {
+            regions[merged++] = padded;
+        }
+    }
+
+    regions.resize(merged);
+}
+
+} // namespace
+
+// Energy + zero-crossing-rate detector with an adaptive noise floor, a short
+// attack (to ignore clicks) and a hangover (to bridge pauses between words)
+class EnergyZcrVad : public VoiceActivityDetector {
+public:
+    explicit EnergyZcrVad(const Settings& settings)
+        : threshold_energy_(settings.silence_threshold * settings.silence_threshold),
+          hangover_ms_(settings.vad_hangover_ms),
+          pad_ms_(settings.vad_speech_pad_ms),
+          capture_rate_(settings.sample_rate) {
+        reset();
+    }
+
+    bool process(const AudioSample* data, size_t count) override {
+        const size_t frame_size = frame_samples(capture_rate_);
+
+        // Callback chunks rarely line up with analysis frames - carry the remainder
+        while (count > 0) {
+            const size_t take = std::min(count, frame_size - pending_);
+            std::copy(data, data + take, pending_frame_.begin() + pending_);
+            pending_ += take;
+            data += take;
+            count -= take;
+
+            if (pending_ == frame_size) {
+                live_.step(classify(pending_frame_.data(), frame_size, live_));
+                pending_ = 0;
+            }
+        }
+
+        return live_.active;
+    }
+
+    void reset() override {
+        live_ = Tracker(attack_frames(), hangover_frames());
+        pending_ = 0;
+    }
+
+    void detect(const AudioView& audio, int sample_rate, SpeechRegions& regions) override {
+        regions.clear();
+        const size_t frame_size = frame_samples(sample_rate);
+        Tracker tracker(attack_frames(), hangover_frames());
+
+        size_t frame_index = 0;
+        size_t region_start = 0;
+        size_t last_speech_end = 0;
+
+        for_each_frame(audio, frame_size, [&](const AudioSample* frame) {
+            const bool speech = classify(frame, frame_size, tracker);
+            const bool was_active = tracker.active;
+            tracker.step(speech);
+
+            if (!was_active && tracker.active) {
+                // Region starts at the first frame of the attack run
+                region_start = (frame_index + 1 - std::min<size_t>(tracker.attack, frame_index + 1)) * frame_size;
+            }
+            if (speech && tracker.active) {
+                last_speech_end = (frame_index + 1) * frame_size;
+            }
+            if (was_active && !tracker.active) {
+                regions.push_back({region_start, last_speech_end});
+            }
+            ++frame_index;
+        });
+
+        if (tracker.active) {
+            regions.push_back({region_start, std::max(last_speech_end, region_start)});
+        }
+
+        pad_and_merge(regions, static_cast<size_t>(pad_ms_) * sample_rate / 1000, audio.size());
+    }
+
+    const char* name() const override {
+        return "energy";
+    }
+
+private:
+    // Per-stream detector state (the live stream and offline passes keep separate copies)
+    struct Tracker {
+        Tracker(int attack_frames = 2, int hangover_frames = 15)
+            : attack(attack_frames), hangover(hangover_frames) {}
+
+        int attack;
+        int hangover;
+        int speech_run = 0;
+        int hangover_left = 0;
+        bool active = false;
+        double noise_energy = -1.0;  // Negative until classify() seeds it
+
+        void step(bool speech) {
+            if (speech) {
+                if (++speech_run >= attack) {
+                    active = true;
+                    hangover_left = hangover;
+                }
+            } else {
+                speech_run = 0;
+                if (active && --hangover_left <= 0) {
+                    active = false;
+                }
+            }
+        }
+    };
+
+    static size_t frame_samples(int sample_rate) {
+        return std::clamp<size_t>(static_cast<size_t>(sample_rate) * kFrameMs / 1000, 1, kMaxFrameSamples);
+    }
+
+    int attack_frames() const { return 2; }
+    int hangover_frames() const { return std::max(1, hangover_ms_ / kFrameMs); }
+
+    bool classify(const AudioSample* frame, size_t count, Tracker& tracker) const {
+        const double energy = dsp::energy(frame, count);
+
+        size_t crossings = 0;
+        for (size_t i = 1; i < count; ++i) {
+            crossings += (frame[i - 1] < 0) != (frame[i] < 0);
+        }
+        const double zcr = static_cast<double>(crossings) / count;
+
+        // Seeded so the first frames face the configured floor, not their own energy: input
+        // that starts mid-speech would otherwise set the floor at speech level for good
+        if (tracker.noise_energy < 0.0) {
+            tracker.noise_energy = threshold_energy_ / kNoiseRatio;
+        }
+
+        // Speech must clear both the configured floor and the adaptive noise floor (~6 dB)
+        const double threshold = std::max(threshold_energy_, tracker.noise_energy * kNoiseRatio);
+        const bool voiced = energy > threshold;
+        // Fricatives (s, f, sh) are quiet but have a high zero-crossing rate
+        const bool unvoiced = energy > threshold * 0.5 && zcr > kFricativeZcr;
+        const bool speech = voiced || unvoiced;
+
+        // The floor follows a quieter frame at once (a running minimum) and rises slowly,
+        // on non-speech frames only
+        if (energy < tracker.noise_energy) {
+            tracker.noise_energy = energy;
+        } else if (!speech) {
+            tracker.noise_energy = 0.95 * tracker.noise_energy + 0.05 * energy;
+        }
+
+        return speech;
+    }
+
+    static constexpr double kNoiseRatio = 4.0;
+    static constexpr double kFricativeZcr = 0.25;
+
+    double threshold_energy_;
+    int hangover_ms_;
+    int pad_ms_;
+    int capture_rate_;
+
+    // Streaming state (audio callback thread only)
+    Tracker live_;
+    std::array<AudioSample, kMaxFrameSamples> pending_frame_{};
+    size_t pending_ = 0;
+};
+
+// Legacy detector: any sample above silence_threshold counts as voice, no trimming
+class PeakVad : public VoiceActivityDetector {
+public:
+    explicit PeakVad(const Settings& settings) : threshold_(settings.silence_threshold) {}
+
+    bool process(const AudioSample* data, size_t count) override {
+        return dsp::peak(data, count) > threshold_;
+    }
+
+    void reset() override {}
+
+    void detect(const AudioView& audio, int sample_rate, SpeechRegions& regions) override {
+        regions.clear();
+        if (!audio.empty()) {
+            regions.push_back({0, audio.size()});
+        }
+    }
+
+    const char* name() const override {
+        return "peak";
+    }
+
+private:
+    float threshold_;
+};
+
+#ifdef SUPERWHISPER_SILERO_VAD
+
+// Silero VAD through whisper.cpp for offline trimming. The neural model is too
+// heavy for the real-time callback, so live detection uses the energy detector.
+class SileroVad : public VoiceActivityDetector {
+public:
+    SileroVad(const Settings& settings, whisper_vad_context* ctx)
+        : realtime_(settings), ctx_(ctx),
+          min_silence_ms_(settings.vad_hangover_ms), pad_ms_(settings.vad_speech_pad_ms) {}
+
+    ~SileroVad() override {
+        whisper_vad_free(ctx_);
+    }
+
+    bool process(const AudioSample* data, size_t count) override {
+        return realtime_.process(data, count);
+    }
+
+    void reset() override {
+        realtime_.reset();
+    }
+
+    void detect(const AudioView& audio, int sample_rate, SpeechRegions& regions) override {
+        // Silero runs at 16 kHz only
+        if (sample_rate != 16000 || audio.empty()) {
+            realtime_.detect(audio, sample_rate, regions);
+            return;
+        }
+
+        pcm_.resize(audio.size());
+        dsp::int16_to_float(audio.first.data(), pcm_.data(), audio.first.size());
+        dsp::int16_to_float(audio.second.data(), pcm_.data() + audio.first.size(), audio.second.size());
+
+        whisper_vad_params params = whisper_vad_default_params();
+        params.min_silence_duration_ms = min_silence_ms_;
+        params.speech_pad_ms = pad_ms_;
+
+        whisper_vad_segments* segments = whisper_vad_segments_from_samples(ctx_, params, pcm_.data(), static_cast<int>(pcm_.size()));
+        if (!segments) {
+            realtime_.detect(audio, sample_rate, regions);
+            return;
+        }
+
+        // Segment times are reported in centiseconds
+        regions.clear();
+        const int n_segments = whisper_vad_segments_n_segments(segments);
+        for (int i = 0; i < n_segments; ++i) {
+            const size_t start = static_cast<size_t>(whisper_vad_segments_get_segment_t0(segments, i) * sample_rate / 100.0f);
+            const size_t end = static_cast<size_t>(whisper_vad_segments_get_segment_t1(segments, i) * sample_rate / 100.0f);
+            regions.push_back({std::min(start, audio.size()), std::min(end, audio.size())});
+        }
+        whisper_vad_free_segments(segments);
+
+        pad_and_merge(regions, 0, audio.size());
+    }
+
+    const char* name() const override {
+        return "silero";
+    }
+
+private:
+    EnergyZcrVad realtime_;
+    whisper_vad_context* ctx_;
+    int min_silence_ms_;
+    int pad_ms_;
+    std::vector<float> pcm_;
+};
+
+#endif
+
+// Factory function
+std::unique_ptr<VoiceActivityDetector> create_vad(const Settings& settings) {
+    if (settings.vad_mode == "peak") {
+        return std::make_unique<PeakVad>(settings);
+    }
+
+    if (settings.vad_mode == "silero") {
+#ifdef SUPERWHISPER_SILERO_VAD
+        whisper_vad_context_params params = whisper_vad_default_context_params();
+        params.n_threads = 1;
+        whisper_vad_context* ctx = whisper_vad_init_from_file_with_params(settings.vad_model_path.c_str(), params);
+        if (ctx) {
+            return std::make_unique<SileroVad>(settings, ctx);
+        }
+        std::cerr << "Failed to load Silero VAD model: " << settings.vad_model_path
+                  << ", falling back to energy VAD" << std::endl;
+#else
+        std::cerr << "Silero VAD not available in this build (SUPERWHISPER_SILERO_VAD=OFF), "
+                  << "falling back to energy VAD" << std::endl;
+#endif
+    } else if (settings.vad_mode != "energy") {
+        std::cerr << "Unknown vad_mode: " << settings.vad_mode << ", using energy VAD" << std::endl;
+    }
+
+    return std::make_unique<EnergyZcrVad>(settings);
+}
+
+} // namespace SuperWhisper
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "audio_types.hpp"
+#include <memory>
+#include <vector>
+
+namespace SuperWhisper {
+
+struct Settings;
+
+// Speech region as sample offsets into the analysed audio [start, end)
+struct SpeechRegion {
+    size_t start = 0;
+    size_t end = 0;
+};
+using SpeechRegions = std::vector<SpeechRegion>;
+
+// Voice activity detector interface
+class VoiceActivityDetector {
+public:
+    virtual ~VoiceActivityDetector() = default;
+
+    // Streaming classification of captured audio - called from the audio callback.
+    // Returns true while speech is active (including the hangover period).
+    virtual bool process(const AudioSample* data, size_t count) = 0;
+    virtual void reset() = 0;
+
+    // Offline detection over a whole recording, padded and merged, in input samples.
+    // Fills `regions` in place so a caller-owned vector keeps its capacity across calls.
+    virtual void detect(const AudioView& audio, int sample_rate, SpeechRegions& regions) = 0;
+    SpeechRegions detect(const AudioView& audio, int sample_rate) {
+        SpeechRegions regions;
+        detect(audio, sample_rate, regions);
+        return regions;
+    }
+
+    virtual const char* name() const = 0;
+};
+
+// Factory function - vad_mode selects "energy" (energy + zero-crossing rate) or "silero"
+std::unique_ptr<VoiceActivityDetector> create_vad(const Settings& settings);
+
+} // namespace SuperWhisper
@@ -0,0 +1,208 @@
+#include "whisper_pool.hpp"
+#include "settings.hpp"
+#include "metrics.hpp"
+#include "system_info.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace SuperWhisper {
+
+class ContextPool : public WhisperPool {
+public:
+    explicit ContextPool(int pool_size) : pool_size_(static_cast<size_t>(std::max(1, pool_size))) {}
+    
+    ~ContextPool() override {
+        unload_model();
+    }
+    
+    using WhisperPool::load_model;
+    
+    bool load_model(const std::string& path, const ModelLoadOptions& options) override {
+        unload_model();
+        
+        // One copy of the weights, one whisper_state per context
+        std::shared_ptr<WhisperModel> model = load_whisper_model(path, options);
+        if (!model) {
+            return false;
+        }
+        
+        std::vector<std::unique_ptr<WhisperWrapper>> contexts;
+        MemoryStats stats;
+        for (size_t i = 0; i < pool_size_; ++i) {
+            auto context = create_whisper_wrapper(model);
+            if (!context) {
+                std::cerr << "Failed to create decode context " << i + 1 << " of " << pool_size_ << std::endl;
+                return false;
+            }
+            
+            // Every context reports the shared weights; count them once
+            const MemoryStats context_stats = context->memory_stats();
+            if (i == 0) {
+                stats = context_stats;
+            } else {
+                stats.kv_cache_bytes += context_stats.kv_cache_bytes;
+                stats.compute_bytes += context_stats.compute_bytes;
+                stats.scratch_bytes += context_stats.scratch_bytes;
+                stats.state_gpu_bytes += context_stats.state_gpu_bytes;
+            }
+            contexts.push_back(std::move(context));
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_ = stats;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = false;
+        }
+        for (auto& context : contexts) {
+            workers_.emplace_back([this, context = std::move(context)]() mutable {
+                worker(*context);
+            });
+        }
+        
+        std::cout << "Whisper pool ready: " << pool_size_ << " context(s)" << std::endl;
+        return true;
+    }
+    
+    void unload_model() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            // Dropping the promises fails the futures of jobs that never started
+            queue_.clear();
+            stats_ = MemoryStats{};
+        }
+        cv_.notify_all();
+        
+        // Running jobs finish first; the workers own (and free) their contexts
+        for (auto& worker : workers_) {
+            if (worker.joinable()) worker.join();
+        }
+        workers_.clear();
+    }
+    
+    bool is_loaded() const override {
+        return !workers_.empty();
+    }
+    
+    using WhisperPool::submit;
+    
+    std::future<TranscriptSegments> submit(AudioBuffer audio, int sample_rate, const Settings& settings,
+                                           SpeechRegions speech, SegmentCallback on_segment) override {
+        Job job{std::move(audio), sample_rate, settings, std::move(speech), std::move(on_segment), {},
+                std::chrono::steady_clock::now()};
+        std::future<TranscriptSegments> result = job.result.get_future();
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_ || workers_.empty()) {
+                job.result.set_exception(std::make_exception_ptr(std::runtime_error("Whisper pool not loaded")));
+                return result;
+            }
+            queue_.push_back(std::move(job));
+        }
+        cv_.notify_one();
+        
+        return result;
+    }
+    
+    MemoryStats memory_stats() const override {
+        MemoryStats stats;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats = stats_;
+        }
+        stats.rss_bytes = current_rss_bytes();
+        stats.peak_rss_bytes = peak_rss_bytes();
+        return stats;
+    }
+    
+    size_t size() const override {
+        return pool_size_;
+    }
+    
+    size_t pending() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.size() + running_;
+    }
+    
+private:
+    struct Job {
+        AudioBuffer audio;
+        int sample_rate;
+        Settings settings;
+        SpeechRegions speech;
+        SegmentCallback on_segment;
+        std::promise<TranscriptSegments> result;
+        std::chrono::steady_clock::time_point queued;
+    };
+    
+    void worker(WhisperWrapper& context) {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+                if (stopping_) return;
+                
+                job = std::move(queue_.front());
+                queue_.pop_front();
+                ++running_;
+                
+                // Each context owns a fixed share of the thread budget: sizing a job by the
+                // jobs visible at dequeue time gave the first of a burst every thread, and a
+                // busy pool ran well over one thread per core. A single context gets them all.
+                job.settings.num_threads = std::max(1, job.settings.num_threads / static_cast<int>(pool_size_));
+            }
+            
+            const auto start = std::chrono::steady_clock::now();
+            metrics::observe(metrics::Histogram::QueueWait, std::chrono::duration<double>(start - job.queued).count());
+            
+            context.set_segment_callback(std::move(job.on_segment));
+            try {
+                const AudioView audio{job.audio, {}, 0};
+                job.result.set_value(context.transcribe_segments(audio, job.sample_rate, job.settings, job.speech));
+            } catch (...) {
+                job.result.set_exception(std::current_exception());
+            }
+            context.set_segment_callback({});
+            
+            if (metrics::enabled() && !job.audio.empty()) {
+                const double decode_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                metrics::observe(metrics::Histogram::RealTimeFactor,
+                                 decode_seconds * job.sample_rate / static_cast<double>(job.audio.size()));
+                metrics::observe(metrics::Histogram::Memory, static_cast<double>(context.get_memory_usage()));
+            }
+            
+            std::lock_guard<std::mutex> lock(mutex_);
+            --running_;
+        }
+    }
+    
+    const size_t pool_size_;
+    std::vector<std::thread> workers_;
+    
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Job> queue_;
+    size_t running_ = 0;
+    bool stopping_ = false;
+    MemoryStats stats_;
+};
+
+// Factory function
+std::unique_ptr<WhisperPool> create_whisper_pool(int pool_size) {
+    return std::make_unique<ContextPool>(pool_size);
+}
+
+} // namespace SuperWhisper
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "whisper_wrapper.hpp"
+#include <future>
+#include <memory>
+#include <string>
+
+namespace SuperWhisper {
+
+struct Settings;
+
+// Fixed set of decode contexts sharing one copy of the model weights.
+// Jobs are queued and picked up by the first free context; each context runs its
+// jobs with settings.num_threads / pool_size threads.
+class WhisperPool {
+public:
+    virtual ~WhisperPool() = default;
+    
+    virtual bool load_model(const std::string& path, const ModelLoadOptions& options) = 0;
+    bool load_model(const std::string& path) {
+        return load_model(path, ModelLoadOptions{});
+    }
+    virtual void unload_model() = 0;
+    virtual bool is_loaded() const = 0;
+    
+    // Queue a transcription job; the pool owns the audio until the job has run.
+    // The future throws if the pool is unloaded before the job starts.
+    // on_segment, if set, gets each segment as it is decoded, on the pool's thread.
+    // `speech` are regions the caller already detected in `audio` (see
+    // WhisperWrapper::transcribe_segments); empty lets the context run its own VAD.
+    virtual std::future<TranscriptSegments> submit(AudioBuffer audio, int sample_rate, const Settings& settings,
+                                                   SpeechRegions speech, SegmentCallback on_segment) = 0;
+    std::future<TranscriptSegments> submit(AudioBuffer audio, int sample_rate, const Settings& settings,
+                                           SegmentCallback on_segment) {
+        return submit(std::move(audio), sample_rate, settings, SpeechRegions{}, std::move(on_segment));
+    }
+    std::future<TranscriptSegments> submit(AudioBuffer audio, int sample_rate, const Settings& settings) {
+        return submit(std::move(audio), sample_rate, settings, SpeechRegions{}, SegmentCallback{});
+    }
+    
+    // Weights once, KV caches and compute buffers of every context, process RSS
+    virtual MemoryStats memory_stats() const = 0;
+    
+    virtual size_t size() const = 0;     // Number of decode contexts
+    virtual size_t pending() const = 0;  // Jobs queued or running
+};
+
+// Factory function - pool_size contexts (at least one)
+std::unique_ptr<WhisperPool> create_whisper_pool(int pool_size);
+
+} // namespace SuperWhisper
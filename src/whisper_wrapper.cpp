@@ -1,80 +1,410 @@
 #include "whisper_wrapper.hpp"
 #include "settings.hpp"
+#include "audio_dsp.hpp"
+#include "vad.hpp"
+#include "resampler.hpp"
+#include "profiler.hpp"
+#include "mapped_file.hpp"
+#include "system_info.hpp"
 #include "whisper.h"
 #include <iostream>
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <string_view>
 #include <thread>
 
 namespace SuperWhisper {
 
+// Backend buffer sizes of a model or state. whisper.cpp has no API for them, but
+// logs ggml_backend_buffer_get_size() of every buffer it allocates.
+struct BufferReport {
+    size_t weights = 0;      // Sum of the per-backend "total size" lines
+    size_t weights_gpu = 0;  // ... of backends other than the CPU
+    size_t model_size = 0;   // "model size" line, for versions without per-buffer totals
+    size_t kv_cache = 0;
+    size_t compute = 0;
+};
+
+// Fills a BufferReport from whisper.cpp's log while in scope. The log callback is
+// process-wide, so captures are serialized; every line is still printed as before.
+class BufferReportCapture {
+public:
+    explicit BufferReportCapture(BufferReport& report) : lock_(mutex()), report_(report) {
+        whisper_log_set(&BufferReportCapture::on_log, this);
+    }
+    
+    ~BufferReportCapture() {
+        whisper_log_set(nullptr, nullptr);  // Back to whisper.cpp's default logger
+    }
+    
+    BufferReportCapture(const BufferReportCapture&) = delete;
+    BufferReportCapture& operator=(const BufferReportCapture&) = delete;
+    
+private:
+    static std::mutex& mutex() {
+        static std::mutex instance;
+        return instance;
+    }
+    
+    static void on_log(ggml_log_level, const char* text, void* user_data) {
+        std::fputs(text, stderr);
+        static_cast<BufferReportCapture*>(user_data)->parse(text);
+    }
+    
+    // Sizes are logged as "<what> = <n> MB" with MB = 1e6 bytes
+    void parse(std::string_view line) {
+        const size_t equals = line.find('=');
+        if (equals == std::string_view::npos) return;
+        const std::string number(line.substr(equals + 1, 32));
+        const size_t bytes = static_cast<size_t>(std::strtod(number.c_str(), nullptr) * 1e6);
+        const std::string_view key = line.substr(0, equals);
+        
+        if (const size_t total = key.find("total size"); total != std::string_view::npos) {
+            // "whisper_model_load:    Metal total size = ..." - the buffer name precedes it
+            std::string_view name = key.substr(0, total);
+            name = name.substr(0, name.find_last_not_of(' ') + 1);
+            name = name.substr(name.find_last_of(' ') + 1);
+            report_.weights += bytes;
+            if (name.substr(0, 3) != "CPU") report_.weights_gpu += bytes;
+        } else if (key.find("model size") != std::string_view::npos) {
+            report_.model_size = bytes;
+        } else if (key.find("kv self size") != std::string_view::npos || key.find("kv cross size") != std::string_view::npos ||
+                   key.find("kv pad size") != std::string_view::npos) {
+            report_.kv_cache += bytes;
+        } else if (key.find("compute buffer") != std::string_view::npos) {
+            report_.compute += bytes;
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock_;
+    BufferReport& report_;
+};
+
+// KV caches as whisper_init_state lays them out: f16 K and V per text layer, the self
+// cache over-allocated 3x the padded text context. Used when no sizes were logged.
+static size_t estimate_kv_cache_bytes(whisper_context* ctx) {
+    auto pad = [](size_t n) { return (n + 255) / 256 * 256; };
+    const size_t text_state = whisper_model_n_text_state(ctx);
+    const size_t text_layers = whisper_model_n_text_layer(ctx);
+    const size_t audio_ctx = pad(whisper_model_n_audio_ctx(ctx));
+    
+    const size_t self = 2 * text_state * text_layers * pad(whisper_model_n_text_ctx(ctx)) * 3;
+    const size_t cross = 2 * text_state * text_layers * audio_ctx;
+    const size_t padding = 2 * static_cast<size_t>(whisper_model_n_audio_state(ctx)) * audio_ctx;
+    return (self + cross + padding) * sizeof(uint16_t);
+}
+
+// Weights and vocabulary of a loaded model. Shared models are created without a
+// decode state, so any number of wrappers can use them with a state of their own.
+struct WhisperModel {
+    whisper_context* ctx = nullptr;
+    std::string path;
+    bool has_state = false;  // ctx carries its own default state (single-wrapper models)
+    BufferReport report;     // Weights, plus the built-in state's buffers when has_state
+    
+    ~WhisperModel() {
+        if (ctx) whisper_free(ctx);
+    }
+};
+
+// whisper.cpp model loader reading out of a read-only mapping: every byte is a
+// memcpy from the shared page cache, with no read() syscalls or stdio buffering
+struct MappedModelReader {
+    const MappedFile* file = nullptr;
+    size_t offset = 0;
+    
+    static size_t read(void* context, void* output, size_t read_size) {
+        auto* reader = static_cast<MappedModelReader*>(context);
+        const size_t count = std::min(read_size, reader->file->size() - reader->offset);
+        std::memcpy(output, reader->file->data() + reader->offset, count);
+        reader->offset += count;
+        return count;
+    }
+    static bool eof(void* context) {
+        auto* reader = static_cast<MappedModelReader*>(context);
+        return reader->offset >= reader->file->size();
+    }
+    static void close(void*) {}  // The caller owns (and unmaps) the file
+};
+
+static whisper_context* init_from_mapping(const MappedFile& file, whisper_context_params cparams, bool with_state) {
+    file.advise_sequential();
+    
+    MappedModelReader reader{&file, 0};
+    whisper_model_loader loader;
+    loader.context = &reader;
+    loader.read = &MappedModelReader::read;
+    loader.eof = &MappedModelReader::eof;
+    loader.close = &MappedModelReader::close;
+    
+    return with_state ? whisper_init_with_params(&loader, cparams)
+                      : whisper_init_with_params_no_state(&loader, cparams);
+}
+
+// with_state: keep whisper.cpp's built-in state, which is the only one
+// whisper_get_timings() can report on
+static std::shared_ptr<WhisperModel> open_model(const std::string& path, const ModelLoadOptions& options, bool with_state) {
+    // Load model with Apple Silicon optimizations
+    // Use the new API for this whisper.cpp version
+    struct whisper_context_params cparams = whisper_context_default_params();
+    
+    // Metal/GPU acceleration on Apple Silicon is a massive speed boost - on unless disabled
+    // in the settings (see model_load_options)
+    cparams.use_gpu = options.use_gpu;
+    
+    // Tensors are copied out of the mapping, so it is only needed while loading.
+    // Falls back to whisper.cpp's own file reader if the file cannot be mapped.
+    auto model = std::make_shared<WhisperModel>();
+    whisper_context* ctx = nullptr;
+    {
+        BufferReportCapture capture(model->report);
+        MappedFile file;
+        if (options.use_mmap && file.open(path)) {
+            ctx = init_from_mapping(file, cparams, with_state);
+        } else {
+            ctx = with_state ? whisper_init_from_file_with_params(path.c_str(), cparams)
+                             : whisper_init_from_file_with_params_no_state(path.c_str(), cparams);
+        }
+    }
+    if (!ctx) {
+        std::cerr << "Failed to load Whisper model: " << path << std::endl;
+        return nullptr;
+    }
+    
+    model->ctx = ctx;
+    model->path = path;
+    model->has_state = with_state;
+    
+    std::cout << "Whisper model loaded successfully: " << path << std::endl;
+    return model;
+}
+
+std::shared_ptr<WhisperModel> load_whisper_model(const std::string& path, const ModelLoadOptions& options) {
+    return open_model(path, options, false);
+}
+
 class WhisperCppWrapper : public WhisperWrapper {
 public:
-    WhisperCppWrapper() : ctx_(nullptr), is_loaded_(false) {}
+    using WhisperWrapper::load_model;
+    using WhisperWrapper::transcribe;
+    using WhisperWrapper::transcribe_segments;
+    
+    WhisperCppWrapper() = default;
+    
+    // Decode on an already loaded model with a state of our own
+    explicit WhisperCppWrapper(std::shared_ptr<WhisperModel> model) {
+        attach(std::move(model));
+    }
     
     ~WhisperCppWrapper() override {
         unload_model();
     }
     
-    bool load_model(const std::string& path) override {
-        if (is_loaded_) {
+    bool load_model(const std::string& path, const ModelLoadOptions& options) override {
+        if (is_loaded()) {
             unload_model();
         }
         
-        // Load model with Apple Silicon optimizations
-        // Use the new API for this whisper.cpp version
-        struct whisper_context_params cparams = whisper_context_default_params();
-        
-        // CRITICAL: Enable Metal GPU acceleration on Apple Silicon for massive speed boost
-        cparams.use_gpu = true;  // Enable Metal/GPU acceleration
-        
-        ctx_ = whisper_init_from_file_with_params(path.c_str(), cparams);
-        if (!ctx_) {
-            std::cerr << "Failed to load Whisper model: " << path << std::endl;
+        // Sole owner of the model: decode on its built-in state
+        model_ = open_model(path, options, true);
+        if (!model_) {
             return false;
         }
+        reserve(kDefaultReserveSamples, 16000);
         
-        is_loaded_ = true;
-        model_path_ = path;
-        
-        std::cout << "Whisper model loaded successfully: " << path << std::endl;
         std::cout << "Memory usage: " << get_memory_usage() / (1024 * 1024) << " MB" << std::endl;
         
         return true;
     }
     
-    std::string transcribe(const AudioBuffer& audio, int sample_rate, const Settings& settings) override {
-        if (!is_loaded_ || !ctx_) {
-            return "";
+    size_t reserve(size_t max_samples, int sample_rate) override {
+        const size_t seconds = max_samples / std::max(sample_rate, 1) + 1;
+        
+        audio_scratch_.reserve(max_samples);
+        if (sample_rate != 16000) {
+            resample_scratch_.reserve((max_samples + kResamplerFlushSamples) * 16000 / std::max(sample_rate, 1) + 4);
         }
+        speech_regions_.reserve(seconds * kRegionsPerSecond);
+        region_map_.reserve(seconds * kRegionsPerSecond);
+        segments_.reserve(seconds);
+        output_.reserve(seconds * kOutputBytesPerSecond);
+        token_scratch_.reserve(kMaxSegmentTokens);
         
-        if (audio.empty()) {
-            return "";
+        return scratch_bytes();
+    }
+    
+    const std::string& transcribe(const AudioView& audio, int sample_rate, const Settings& settings) override {
+        decode(audio, sample_rate, settings);
+        commit_decoded();
+        profiler::ScopedTimer timer("format_transcript");
+        format_transcript(std::span<const TranscriptSegment>(segments_.data(), n_segments_), settings.output_format, output_);
+        return output_;
+    }
+    
+    TranscriptSegments transcribe_segments(const AudioView& audio, int sample_rate, const Settings& settings) override {
+        decode(audio, sample_rate, settings);
+        return TranscriptSegments(segments_.begin(), segments_.begin() + n_segments_);
+    }
+    
+    TranscriptSegments transcribe_segments(const AudioView& audio, int sample_rate, const Settings& settings,
+                                           const SpeechRegions& speech) override {
+        decode(audio, sample_rate, settings, speech.empty() ? nullptr : &speech);
+        return TranscriptSegments(segments_.begin(), segments_.begin() + n_segments_);
+    }
+    
+    bool is_loaded() const override {
+        return model_ && (state_ != nullptr || model_->has_state);
+    }
+    
+    void set_context_tokens(int max_tokens) override {
+        context_limit_ = static_cast<size_t>(std::clamp(max_tokens, 0, kMaxPromptTokens));
+        context_.reserve(context_limit_ + kMaxSegmentTokens);
+        trim_context();
+    }
+    
+    // Text from elsewhere (stitched or edited) has no token ids yet - tokenize it
+    void commit_context(const std::string& text) override {
+        if (context_limit_ == 0 || !model_ || text.empty()) return;
+        
+        token_scratch_.resize(std::max(token_scratch_.capacity(), kMaxSegmentTokens));
+        int n = whisper_tokenize(model_->ctx, text.c_str(), token_scratch_.data(), static_cast<int>(token_scratch_.size()));
+        if (n < 0) {
+            token_scratch_.resize(static_cast<size_t>(-n));
+            n = whisper_tokenize(model_->ctx, text.c_str(), token_scratch_.data(), static_cast<int>(token_scratch_.size()));
+        }
+        if (n > 0) {
+            context_.insert(context_.end(), token_scratch_.begin(), token_scratch_.begin() + n);
+            trim_context();
         }
+        token_scratch_.clear();
+    }
+    
+    void reset_context() override {
+        context_.clear();
+    }
+    
+    void set_segment_callback(SegmentCallback callback) override {
+        segment_callback_ = std::move(callback);
+    }
+    
+    DecodeTimings last_timings() const override {
+        return timings_;
+    }
+    
+    void unload_model() override {
+        if (state_) {
+            whisper_free_state(state_);
+            state_ = nullptr;
+        }
+        // The weights are freed once the last wrapper sharing them lets go
+        model_.reset();
+        state_report_ = BufferReport{};
         
-        // Prepare audio data for Whisper with memory optimization
-        // Whisper expects 16kHz, 16-bit PCM, mono
-        std::vector<float> audio_float;
-        audio_float.reserve(audio.size() + 1024);  // Extra space to avoid reallocations
+        // Release scratch memory together with the model
+        std::vector<float>().swap(audio_scratch_);
+        std::vector<float>().swap(resample_scratch_);
+        SpeechRegions().swap(speech_regions_);
+        std::vector<RegionMapping>().swap(region_map_);
+        TranscriptSegments().swap(segments_);
+        n_segments_ = 0;
+        std::string().swap(output_);
+        std::vector<whisper_token>().swap(token_scratch_);
         
-        // Convert int16 to float32 and normalize to [-1, 1]
-        for (int16_t sample : audio) {
-            audio_float.push_back(static_cast<float>(sample) / 32768.0f);
+        // Token ids are only meaningful for the vocabulary they came from
+        context_.clear();
+    }
+    
+    MemoryStats memory_stats() const override {
+        MemoryStats stats;
+        stats.rss_bytes = current_rss_bytes();
+        stats.peak_rss_bytes = peak_rss_bytes();
+        if (!model_) return stats;
+        
+        const BufferReport& model = model_->report;
+        stats.weights_bytes = model.weights > 0 ? model.weights : model.model_size;
+        stats.weights_gpu_bytes = model.weights_gpu;
+        stats.kv_cache_bytes = model.kv_cache + state_report_.kv_cache;
+        stats.compute_bytes = model.compute + state_report_.compute;
+        stats.scratch_bytes = scratch_bytes();
+        stats.measured = stats.weights_bytes > 0;
+        
+        // Older/quieter whisper.cpp builds: the file is ~the tensor data, KV from hparams
+        if (!stats.measured) {
+            std::error_code ec;
+            stats.weights_bytes = static_cast<size_t>(std::filesystem::file_size(model_->path, ec));
+            if (ec) stats.weights_bytes = 0;
+        }
+        if (stats.kv_cache_bytes == 0) {
+            stats.kv_cache_bytes = estimate_kv_cache_bytes(model_->ctx);
         }
         
-        // Resample if necessary with memory optimization
-        std::vector<float> resampled_audio;
-        if (sample_rate != 16000) {
-            resampled_audio = resample_audio(audio_float, sample_rate, 16000);
-        } else {
-            resampled_audio = std::move(audio_float);
+        // A state lives on the first backend, which is the GPU whenever the weights are
+        if (stats.weights_gpu_bytes > 0) {
+            stats.state_gpu_bytes = stats.kv_cache_bytes + stats.compute_bytes;
+        }
+        return stats;
+    }
+    
+private:
+    // Decode into segments_[0, n_segments_). Every buffer used here is reused across calls.
+    // `speech`, if given, are regions the caller already detected; the VAD is not run again.
+    void decode(const AudioView& audio, int sample_rate, const Settings& settings, const SpeechRegions* speech = nullptr) {
+        n_segments_ = 0;
+        const auto start = std::chrono::steady_clock::now();
+        timings_ = DecodeTimings{};
+        timings_.audio_ms = sample_rate > 0 ? audio.size() * 1000.0 / sample_rate : 0.0;
+        
+        if (!is_loaded()) {
+            return;
+        }
+        
+        if (audio.empty()) {
+            return;
+        }
+        // Prepare audio data for Whisper - expects 16kHz float32 mono.
+        // Single conversion pass into a scratch buffer that keeps its capacity across calls.
+        {
+            profiler::ScopedTimer timer("int16_to_float");
+            audio_scratch_.resize(audio.size());
+            convert_to_float(audio.first, audio_scratch_.data());
+            convert_to_float(audio.second, audio_scratch_.data() + audio.first.size());
+        }
+        
+        // Skip non-speech entirely - less audio for the encoder is the biggest win
+        region_map_.clear();
+        if (settings.vad_trim_silence && speech) {
+            compact_speech(*speech, sample_rate);
+        } else if (settings.vad_trim_silence) {
+            profiler::ScopedTimer timer("vad_trim");
+            if (!vad_ || vad_mode_ != settings.vad_mode) {
+                vad_ = create_vad(settings);
+                vad_mode_ = settings.vad_mode;
+            }
+            
+            vad_->detect(audio, sample_rate, speech_regions_);
+            if (speech_regions_.empty()) {
+                return;  // No speech at all, nothing to decode
+            }
+            compact_speech(speech_regions_, sample_rate);
         }
         
-        // Shrink to fit to free unused memory before inference
-        resampled_audio.shrink_to_fit();
+        // Resample if necessary (into a second reusable buffer)
+        const std::vector<float>* pcm = &audio_scratch_;
+        if (sample_rate != 16000) {
+            profiler::ScopedTimer timer("resample");
+            resample_audio(audio_scratch_, sample_rate, 16000, resample_scratch_);
+            pcm = &resample_scratch_;
+        }
         
         // Configure transcription parameters from settings
-        whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+        const bool beam_search = settings.sampling_strategy == "beam_search";
+        whisper_full_params params = whisper_full_default_params(beam_search ? WHISPER_SAMPLING_BEAM_SEARCH : WHISPER_SAMPLING_GREEDY);
         
         // Use settings for all configurable parameters
         params.n_threads = settings.num_threads;
@@ -84,6 +414,14 @@ public:
         params.max_tokens = settings.max_tokens;
         params.temperature = settings.temperature;
         
+        // Decoding strategy (see apply_decode_preset). whisper.cpp samples best_of
+        // candidates only for the fallback temperatures above 0.
+        params.greedy.best_of = std::max(1, settings.best_of);
+        params.beam_search.beam_size = std::max(1, settings.beam_size);
+        params.temperature_inc = std::max(0.0f, settings.temperature_inc);
+        params.single_segment = settings.single_segment;
+        params.no_timestamps = settings.no_timestamps;
+        
         // Note: top_p, top_k, and repetition_penalty are not available in whisper.cpp
         // These are kept in settings for future compatibility but not used here
         
@@ -103,194 +441,364 @@ public:
         params.logprob_thold = settings.logprob_threshold;
         params.no_speech_thold = settings.no_speech_threshold;
         
+        // Prompt with the carried context. whisper.cpp's own carry-over (no_context = false)
+        // keeps everything it ever decoded, uncommitted streaming hypotheses included.
+        params.no_context = true;
+        if (!context_.empty()) {
+            params.prompt_tokens = context_.data();
+            params.prompt_n_tokens = static_cast<int>(context_.size());
+        }
+        
+        // Segments reach the callback as each 30 s window is decoded
+        if (segment_callback_) {
+            params.new_segment_callback = &WhisperCppWrapper::on_new_segments;
+            params.new_segment_callback_user_data = this;
+            decode_rate_ = sample_rate;
+        }
+        
         // Run transcription
-        int result = whisper_full(ctx_, params, resampled_audio.data(), resampled_audio.size());
+        const auto inference_start = std::chrono::steady_clock::now();
+        timings_.preprocess_ms = elapsed_ms(start, inference_start);
+        
+        int result = full(params, pcm->data(), static_cast<int>(pcm->size()));
+        collect_timings(inference_start);
+        profile_inference(inference_start);
         if (result != 0) {
             std::cerr << "Transcription failed with error: " << result << std::endl;
-            return "";
+            return;
         }
         
-        // Extract text based on output format
-        std::string transcription;
-        
-        if (settings.output_format == "json") {
-            // JSON output format
-            transcription = "{\n  \"segments\": [\n";
-            const int n_segments = whisper_full_n_segments(ctx_);
-            
-            for (int i = 0; i < n_segments; ++i) {
-                const char* text = whisper_full_get_segment_text(ctx_, i);
-                float start_time = whisper_full_get_segment_t0(ctx_, i) / 100.0f;
-                float end_time = whisper_full_get_segment_t1(ctx_, i) / 100.0f;
-                
-                if (text) {
-                    if (i > 0) transcription += ",\n";
-                    transcription += "    {\n";
-                    transcription += "      \"id\": " + std::to_string(i) + ",\n";
-                    transcription += "      \"start\": " + std::to_string(start_time) + ",\n";
-                    transcription += "      \"end\": " + std::to_string(end_time) + ",\n";
-                    transcription += "      \"text\": \"" + std::string(text) + "\"\n";
-                    transcription += "    }";
+        // Collect segments (whisper timestamps are in 10 ms units). Slots past the count
+        // are kept, so their strings' capacity is reused by the next utterance.
+        const int n_segments = segment_count();
+        for (int i = 0; i < n_segments; ++i) {
+            const char* text = segment_text(i);
+            if (text) {
+                if (n_segments_ == segments_.size()) {
+                    segments_.emplace_back();
                 }
+                fill_segment(i, text, sample_rate, segments_[n_segments_++]);
             }
-            transcription += "\n  ]\n}";
-            
-        } else if (settings.output_format == "srt") {
-            // SRT subtitle format
-            const int n_segments = whisper_full_n_segments(ctx_);
-            
-            for (int i = 0; i < n_segments; ++i) {
-                const char* text = whisper_full_get_segment_text(ctx_, i);
-                float start_time = whisper_full_get_segment_t0(ctx_, i) / 100.0f;
-                float end_time = whisper_full_get_segment_t1(ctx_, i) / 100.0f;
-                
-                if (text) {
-                    transcription += std::to_string(i + 1) + "\n";
-                    transcription += format_time_srt(start_time) + " --> " + format_time_srt(end_time) + "\n";
-                    transcription += std::string(text) + "\n\n";
-                }
-            }
-            
-        } else if (settings.output_format == "vtt") {
-            // VTT subtitle format
-            transcription = "WEBVTT\n\n";
-            const int n_segments = whisper_full_n_segments(ctx_);
-            
-            for (int i = 0; i < n_segments; ++i) {
-                const char* text = whisper_full_get_segment_text(ctx_, i);
-                float start_time = whisper_full_get_segment_t0(ctx_, i) / 100.0f;
-                float end_time = whisper_full_get_segment_t1(ctx_, i) / 100.0f;
-                
-                if (text) {
-                    transcription += format_time_vtt(start_time) + " --> " + format_time_vtt(end_time) + "\n";
-                    transcription += std::string(text) + "\n\n";
-                }
+        }
+    }
+    
+    void fill_segment(int index, const char* text, int sample_rate, TranscriptSegment& segment) {
+        segment.start_ms = to_original_ms(segment_t0(index) * 10, sample_rate);
+        segment.end_ms = to_original_ms(segment_t1(index) * 10, sample_rate);
+        segment.text.assign(text);
+        score_segment(index, segment);
+    }
+    
+    // whisper.cpp's new_segment_callback: the last n_new segments were just decoded.
+    // The state it passes is ours (or the context's built-in one), so the getters apply.
+    static void on_new_segments(whisper_context*, whisper_state*, int n_new, void* user_data) {
+        auto* self = static_cast<WhisperCppWrapper*>(user_data);
+        const int n_segments = self->segment_count();
+        for (int i = std::max(0, n_segments - n_new); i < n_segments; ++i) {
+            if (const char* text = self->segment_text(i)) {
+                self->fill_segment(i, text, self->decode_rate_, self->live_segment_);
+                self->segment_callback_(self->live_segment_);
             }
-            
-        } else if (settings.output_format == "csv") {
-            // CSV format
-            transcription = "start_time,end_time,text\n";
-            const int n_segments = whisper_full_n_segments(ctx_);
-            
-            for (int i = 0; i < n_segments; ++i) {
-                const char* text = whisper_full_get_segment_text(ctx_, i);
-                float start_time = whisper_full_get_segment_t0(ctx_, i) / 100.0f;
-                float end_time = whisper_full_get_segment_t1(ctx_, i) / 100.0f;
-                
-                if (text) {
-                    transcription += std::to_string(start_time) + "," + std::to_string(end_time) + ",\"" + std::string(text) + "\"\n";
-                }
+        }
+    }
+    
+    // Take a reference to the model and allocate this wrapper's decode state
+    bool attach(std::shared_ptr<WhisperModel> model) {
+        if (!model) return false;
+        
+        {
+            BufferReportCapture capture(state_report_);
+            state_ = whisper_init_state(model->ctx);
+        }
+        if (!state_) {
+            std::cerr << "Failed to allocate Whisper decode state" << std::endl;
+            return false;
+        }
+        model_ = std::move(model);
+        
+        // Size the buffers for a full 30 s window once; callers with longer sessions reserve more
+        reserve(kDefaultReserveSamples, 16000);
+        return true;
+    }
+    
+    // Append the text tokens of the last decode to the carried context
+    void commit_decoded() {
+        if (context_limit_ == 0 || n_segments_ == 0) return;
+        
+        const whisper_token eot = whisper_token_eot(model_->ctx);
+        const int n_segments = segment_count();
+        for (int i = 0; i < n_segments; ++i) {
+            const int n_tokens = token_count(i);
+            for (int t = 0; t < n_tokens; ++t) {
+                const whisper_token id = token_id(i, t);
+                if (id < eot) context_.push_back(id);
             }
+            trim_context();  // Per segment, so the reserved capacity is never exceeded
+        }
+    }
+    
+    // Keep the newest context_limit_ tokens, in place
+    void trim_context() {
+        if (context_.size() > context_limit_) {
+            context_.erase(context_.begin(), context_.end() - context_limit_);
+        }
+    }
+    
+    // Average log probability and token entropy, computed like whisper.cpp's own
+    // temperature fallback checks (special tokens at or above EOT are skipped)
+    void score_segment(int index, TranscriptSegment& segment) {
+        const whisper_token eot = whisper_token_eot(model_->ctx);
+        const int n_tokens = token_count(index);
+        
+        token_scratch_.clear();
+        double logprob_sum = 0.0;
+        for (int t = 0; t < n_tokens; ++t) {
+            const whisper_token id = token_id(index, t);
+            if (id >= eot) continue;
             
-        } else {
-            // Default text format
-            const int n_segments = whisper_full_n_segments(ctx_);
-            
-            for (int i = 0; i < n_segments; ++i) {
-                const char* text = whisper_full_get_segment_text(ctx_, i);
-                if (text) {
-                    transcription += text;
-                }
-            }
+            const float p = state_ ? whisper_full_get_token_p_from_state(state_, index, t)
+                                   : whisper_full_get_token_p(model_->ctx, index, t);
+            logprob_sum += std::log(std::max(p, 1e-10f));
+            token_scratch_.push_back(id);
         }
         
-        return transcription;
+        segment.token_count = static_cast<int>(token_scratch_.size());
+        segment.avg_logprob = token_scratch_.empty() ? 0.0f : static_cast<float>(logprob_sum / token_scratch_.size());
+        
+        // Entropy over how often each id occurs: sorting groups equal ids into runs
+        std::sort(token_scratch_.begin(), token_scratch_.end());
+        double entropy = 0.0;
+        for (size_t run = 0; run < token_scratch_.size();) {
+            size_t next = run;
+            while (next < token_scratch_.size() && token_scratch_[next] == token_scratch_[run]) ++next;
+            const double p = static_cast<double>(next - run) / token_scratch_.size();
+            entropy -= p * std::log(p);
+            run = next;
+        }
+        segment.token_entropy = static_cast<float>(entropy);
     }
     
-    bool is_loaded() const override {
-        return is_loaded_ && ctx_ != nullptr;
+    size_t scratch_bytes() const {
+        return audio_scratch_.capacity() * sizeof(float) + resample_scratch_.capacity() * sizeof(float) +
+               speech_regions_.capacity() * sizeof(SpeechRegion) + region_map_.capacity() * sizeof(RegionMapping) +
+               segments_.capacity() * sizeof(TranscriptSegment) + output_.capacity() +
+               (token_scratch_.capacity() + context_.capacity()) * sizeof(whisper_token);
     }
     
-    void unload_model() override {
-        if (ctx_) {
-            whisper_free(ctx_);
-            ctx_ = nullptr;
-        }
-        is_loaded_ = false;
-        model_path_.clear();
-    }
-    
-    size_t get_memory_usage() const override {
-        if (!ctx_) return 0;
-        
-        // Estimate memory usage based on model size
-        // This is approximate - whisper.cpp doesn't expose exact memory usage
-        size_t estimated_size = 0;
-        
-        // Base model sizes (approximate)
-        if (model_path_.find("tiny") != std::string::npos) {
-            estimated_size = 39 * 1024 * 1024;  // ~39 MB
-        } else if (model_path_.find("base") != std::string::npos) {
-            estimated_size = 74 * 1024 * 1024;  // ~74 MB
-        } else if (model_path_.find("small") != std::string::npos) {
-            estimated_size = 244 * 1024 * 1024;  // ~244 MB
-        } else if (model_path_.find("medium") != std::string::npos) {
-            estimated_size = 769 * 1024 * 1024;  // ~769 MB
-        } else if (model_path_.find("large") != std::string::npos) {
-            estimated_size = 1550 * 1024 * 1024;  // ~1.55 GB
-        } else {
-            estimated_size = 100 * 1024 * 1024;  // Default estimate
+    // whisper.cpp calls on our own state, or on the context's built-in one
+    int full(const whisper_full_params& params, const float* samples, int count) {
+        return state_ ? whisper_full_with_state(model_->ctx, state_, params, samples, count)
+                      : whisper_full(model_->ctx, params, samples, count);
+    }
+    int segment_count() const {
+        return state_ ? whisper_full_n_segments_from_state(state_) : whisper_full_n_segments(model_->ctx);
+    }
+    const char* segment_text(int i) const {
+        return state_ ? whisper_full_get_segment_text_from_state(state_, i) : whisper_full_get_segment_text(model_->ctx, i);
+    }
+    int64_t segment_t0(int i) const {
+        return state_ ? whisper_full_get_segment_t0_from_state(state_, i) : whisper_full_get_segment_t0(model_->ctx, i);
+    }
+    int64_t segment_t1(int i) const {
+        return state_ ? whisper_full_get_segment_t1_from_state(state_, i) : whisper_full_get_segment_t1(model_->ctx, i);
+    }
+    int token_count(int i) const {
+        return state_ ? whisper_full_n_tokens_from_state(state_, i) : whisper_full_n_tokens(model_->ctx, i);
+    }
+    whisper_token token_id(int i, int t) const {
+        return state_ ? whisper_full_get_token_id_from_state(state_, i, t) : whisper_full_get_token_id(model_->ctx, i, t);
+    }
+    
+    // whisper_full plus its encoder/decoder split. whisper.cpp only reports totals,
+    // so the split is laid out back to back from the start of the call.
+    void profile_inference(std::chrono::steady_clock::time_point inference_start) const {
+        if (!profiler::enabled()) return;
+        
+        const auto end = std::chrono::steady_clock::now();
+        profiler::record("whisper_full", inference_start, end);
+        if (timings_.encode_ms > 0.0 || timings_.decode_ms > 0.0) {
+            const auto encode_end = inference_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::milli>(timings_.encode_ms));
+            const auto decode_end = encode_end + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::milli>(timings_.decode_ms));
+            profiler::record("  encoder (whisper.cpp)", inference_start, encode_end);
+            profiler::record("  decoder (whisper.cpp)", encode_end, decode_end);
         }
+    }
+    
+    static double elapsed_ms(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+    
+    // Encoder/decoder split is only tracked by whisper.cpp for the built-in state
+    void collect_timings(std::chrono::steady_clock::time_point inference_start) {
+        timings_.inference_ms = elapsed_ms(inference_start, std::chrono::steady_clock::now());
+        if (state_) return;
         
-        return estimated_size;
+        if (const whisper_timings* timings = whisper_get_timings(model_->ctx)) {
+            timings_.encode_ms = timings->encode_ms;
+            timings_.decode_ms = timings->sample_ms + timings->decode_ms + timings->batchd_ms + timings->prompt_ms;
+        }
+        whisper_reset_timings(model_->ctx);  // Counters accumulate across calls otherwise
     }
     
-private:
-    // Simple audio resampling (linear interpolation)
-    // For production, use a proper resampling library
-    std::vector<float> resample_audio(const std::vector<float>& input, int input_rate, int output_rate) {
-        if (input_rate == output_rate) {
-            return input;
-        }
-        
-        double ratio = static_cast<double>(output_rate) / input_rate;
-        size_t output_size = static_cast<size_t>(input.size() * ratio);
-        std::vector<float> output(output_size);
-        
-        for (size_t i = 0; i < output_size; ++i) {
-            double input_index = i / ratio;
-            size_t index1 = static_cast<size_t>(input_index);
-            size_t index2 = std::min(index1 + 1, input.size() - 1);
-            double fraction = input_index - index1;
+    // Convert int16 to float32 and normalize to [-1, 1] (SIMD kernel)
+    static void convert_to_float(std::span<const AudioSample> input, float* output) {
+        dsp::int16_to_float(input.data(), output, input.size());
+    }
+    
+    // Keep only the speech regions in audio_scratch_, separated by short silences.
+    // Works in place: the write cursor never overtakes the next region's start.
+    void compact_speech(const SpeechRegions& regions, int sample_rate) {
+        if (regions.size() == 1 && regions[0].start == 0 && regions[0].end >= audio_scratch_.size()) {
+            return;  // All speech
+        }
+        
+        const size_t max_gap = static_cast<size_t>(sample_rate) * kRegionGapMs / 1000;
+        size_t write = 0;
+        size_t previous_end = 0;
+        
+        for (const auto& region : regions) {
+            if (write > 0) {
+                const size_t gap = std::min(max_gap, region.start - previous_end);
+                std::fill_n(audio_scratch_.begin() + write, gap, 0.0f);
+                write += gap;
+            }
             
-            output[i] = input[index1] * (1.0 - fraction) + input[index2] * fraction;
+            const size_t length = region.end - region.start;
+            region_map_.push_back({write, region.start, length});
+            std::copy(audio_scratch_.begin() + region.start, audio_scratch_.begin() + region.end, audio_scratch_.begin() + write);
+            write += length;
+            previous_end = region.end;
         }
         
-        return output;
+        audio_scratch_.resize(write);
     }
     
-    // Helper function to format time for SRT format (HH:MM:SS,mmm)
-    std::string format_time_srt(float seconds) {
-        int hours = static_cast<int>(seconds) / 3600;
-        int minutes = (static_cast<int>(seconds) % 3600) / 60;
-        int secs = static_cast<int>(seconds) % 60;
-        int millisecs = static_cast<int>((seconds - static_cast<int>(seconds)) * 1000);
+    // Map a timestamp in the compacted audio back to the original recording
+    int64_t to_original_ms(int64_t compact_ms, int sample_rate) const {
+        if (region_map_.empty()) return compact_ms;
+        
+        const size_t position = static_cast<size_t>(std::max<int64_t>(compact_ms, 0)) * sample_rate / 1000;
+        const RegionMapping* mapping = &region_map_.front();
+        for (const auto& candidate : region_map_) {
+            if (candidate.compact_start > position) break;
+            mapping = &candidate;
+        }
         
-        char buffer[16];
-        snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d,%03d", hours, minutes, secs, millisecs);
-        return std::string(buffer);
+        const size_t offset = std::min(position - std::min(position, mapping->compact_start), mapping->length);
+        return static_cast<int64_t>(mapping->original_start + offset) * 1000 / sample_rate;
     }
     
-    // Helper function to format time for VTT format (HH:MM:SS.mmm)
-    std::string format_time_vtt(float seconds) {
-        int hours = static_cast<int>(seconds) / 3600;
-        int minutes = (static_cast<int>(seconds) % 3600) / 60;
-        int secs = static_cast<int>(seconds) % 60;
-        int millisecs = static_cast<int>((seconds - static_cast<int>(seconds)) * 1000);
+    // Polyphase FIR resampling - the resampler (and its filter bank) is kept per input rate
+    void resample_audio(const std::vector<float>& input, int input_rate, int output_rate, std::vector<float>& output) {
+        if (!resampler_ || resampler_->input_rate() != input_rate || resampler_->output_rate() != output_rate) {
+            resampler_ = std::make_unique<PolyphaseResampler>(input_rate, output_rate);
+        } else {
+            resampler_->reset();
+        }
         
-        char buffer[16];
-        snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d.%03d", hours, minutes, secs, millisecs);
-        return std::string(buffer);
+        output.resize(resampler_->max_output(input.size()) + resampler_->max_output(kResamplerFlushSamples));
+        size_t produced = resampler_->process(input.data(), input.size(), output.data());
+        produced += resampler_->flush(output.data() + produced);
+        output.resize(produced);
     }
     
-    whisper_context* ctx_;
-    bool is_loaded_;
-    std::string model_path_;
+    std::shared_ptr<WhisperModel> model_;
+    whisper_state* state_ = nullptr;  // KV caches, mel buffer and results for this wrapper only
+    BufferReport state_report_;       // Buffers of state_ (the built-in state is in the model's report)
+    
+    // Per-session arena: conversion/resampling buffers, VAD regions, segments and the
+    // output text. Sized by reserve(), never shrunk while loaded.
+    std::vector<float> audio_scratch_;
+    std::vector<float> resample_scratch_;
+    std::unique_ptr<PolyphaseResampler> resampler_;
+    SpeechRegions speech_regions_;
+    TranscriptSegments segments_;
+    size_t n_segments_ = 0;
+    std::string output_;
+    std::vector<whisper_token> token_scratch_;
+    
+    // Carried decoder prompt: the newest committed text tokens, oldest first
+    std::vector<whisper_token> context_;
+    size_t context_limit_ = 0;
+    static constexpr int kMaxPromptTokens = 224;          // whisper.cpp keeps at most n_text_ctx / 2 of a prompt
+    static constexpr size_t kMaxSegmentTokens = 448;      // Whisper's text context
+    static constexpr size_t kResamplerFlushSamples = 64;  // Matches the default taps per phase
+    static constexpr size_t kDefaultReserveSamples = 16000 * 30;
+    static constexpr size_t kRegionsPerSecond = 4;        // Generous: regions are at least attack + hangover long
+    static constexpr size_t kOutputBytesPerSecond = 64;   // Speech is ~15 chars/s; leaves room for json/srt markup
+    
+    DecodeTimings timings_;
+    
+    // Incremental delivery; live_segment_ is reused for every callback
+    SegmentCallback segment_callback_;
+    TranscriptSegment live_segment_;
+    int decode_rate_ = 16000;
+    
+    // Silence trimming: detector plus compacted -> original position mapping
+    struct RegionMapping {
+        size_t compact_start;
+        size_t original_start;
+        size_t length;
+    };
+    static constexpr int kRegionGapMs = 100;
+    std::unique_ptr<VoiceActivityDetector> vad_;
+    std::string vad_mode_;
+    std::vector<RegionMapping> region_map_;
 };
 
+ModelLoadOptions model_load_options(const Settings& settings) {
+    ModelLoadOptions options;
+#ifdef __APPLE__
+    options.use_gpu = settings.use_gpu && settings.use_metal;
+#else
+    options.use_gpu = settings.use_gpu;
+#endif
+    return options;
+}
+
+static double to_mb(size_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+void print_memory_stats(const MemoryStats& stats) {
+    char line[128];
+    std::cout << "Memory (" << (stats.measured ? "ggml backend buffers" : "estimated from model file and hparams") << "):\n";
+    std::snprintf(line, sizeof(line), "  Weights:         %8.1f MB (%.1f MB on GPU)\n", to_mb(stats.weights_bytes), to_mb(stats.weights_gpu_bytes));
+    std::cout << line;
+    std::snprintf(line, sizeof(line), "  KV cache:        %8.1f MB\n", to_mb(stats.kv_cache_bytes));
+    std::cout << line;
+    std::snprintf(line, sizeof(line), "  Compute buffers: %8.1f MB%s\n", to_mb(stats.compute_bytes), stats.compute_bytes > 0 ? "" : " (not reported)");
+    std::cout << line;
+    std::snprintf(line, sizeof(line), "  Audio/text:      %8.1f MB\n", to_mb(stats.scratch_bytes));
+    std::cout << line;
+    std::snprintf(line, sizeof(line), "  Total:           %8.1f MB (%.1f MB on GPU)\n", to_mb(stats.total_bytes()), to_mb(stats.gpu_bytes()));
+    std::cout << line;
+    std::snprintf(line, sizeof(line), "  Process RSS:     %8.1f MB (peak %.1f MB)\n", to_mb(stats.rss_bytes), to_mb(stats.peak_rss_bytes));
+    std::cout << line << std::flush;
+}
+
+bool check_memory_budget(const MemoryStats& stats, int budget_mb) {
+    if (budget_mb <= 0 || stats.total_bytes() <= static_cast<size_t>(budget_mb) * 1024 * 1024) {
+        return true;
+    }
+    std::cerr << "Model needs " << static_cast<int>(to_mb(stats.total_bytes())) << " MB, over memory_budget_mb ("
+              << budget_mb << " MB)" << std::endl;
+    return false;
+}
+
 // Factory function
 std::unique_ptr<WhisperWrapper> create_whisper_wrapper() {
     return std::make_unique<WhisperCppWrapper>();
 }
 
+std::unique_ptr<WhisperWrapper> create_whisper_wrapper(std::shared_ptr<WhisperModel> model) {
+    auto wrapper = std::make_unique<WhisperCppWrapper>(std::move(model));
+    if (!wrapper->is_loaded()) {
+        return nullptr;
+    }
+    return wrapper;
+}
+
 } // namespace SuperWhisper
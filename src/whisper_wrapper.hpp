@@ -1,6 +1,11 @@
 #pragma once
 
+#include "audio_types.hpp"
+#include "vad.hpp"
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -9,25 +14,142 @@ namespace SuperWhisper {
 // Forward declaration
 struct Settings;
 
-// Audio sample type - using 16-bit for memory efficiency
-using AudioSample = int16_t;
-using AudioBuffer = std::vector<AudioSample>;
+// Transcribed segment with absolute timestamps in milliseconds
+struct TranscriptSegment {
+    int64_t start_ms = 0;
+    int64_t end_ms = 0;
+    std::string text;
+    
+    // Decoder confidence over the segment's text tokens
+    int token_count = 0;
+    float avg_logprob = 0.0f;    // Mean log probability of the sampled tokens
+    float token_entropy = 0.0f;  // Entropy of the token id distribution (nats); low means repetition
+};
+using TranscriptSegments = std::vector<TranscriptSegment>;
+
+// Receives each segment as soon as it is final, on the thread that is decoding
+using SegmentCallback = std::function<void(const TranscriptSegment&)>;
+
+// How a model is brought into memory
+struct ModelLoadOptions {
+    bool use_gpu = true;   // Metal / CUDA backend when whisper.cpp was built with one
+    bool use_mmap = true;  // Read the file through a shared page-cache mapping instead of fread
+};
+
+// Where the time of the last transcription went, in milliseconds
+struct DecodeTimings {
+    double preprocess_ms = 0.0;  // int16 -> float, VAD trimming, resampling
+    double inference_ms = 0.0;   // The whole whisper_full call
+    double encode_ms = 0.0;      // Encoder, from whisper.cpp (0 when not reported)
+    double decode_ms = 0.0;      // Prompt, decoder passes and sampling, from whisper.cpp
+    double audio_ms = 0.0;       // Duration of the input audio
+};
+
+// Where a loaded model's memory goes, in bytes
+struct MemoryStats {
+    size_t weights_bytes = 0;      // Model tensors (one copy, shared by every context on the model)
+    size_t kv_cache_bytes = 0;     // Self-attention, cross-attention and padding KV caches
+    size_t compute_bytes = 0;      // ggml compute buffers (conv, encode, cross, decode graphs)
+    size_t scratch_bytes = 0;      // Reusable audio/segment/text buffers of the wrapper(s)
+    size_t weights_gpu_bytes = 0;  // Part of weights_bytes held in GPU / Metal buffers
+    size_t state_gpu_bytes = 0;    // Part of the KV caches and compute buffers held there
+    size_t rss_bytes = 0;          // Whole process, now
+    size_t peak_rss_bytes = 0;     // Whole process, high-water mark
+    bool measured = false;         // Sizes of the ggml backend buffers (false: estimated from hparams)
+    
+    size_t total_bytes() const { return weights_bytes + kv_cache_bytes + compute_bytes + scratch_bytes; }
+    size_t gpu_bytes() const { return weights_gpu_bytes + state_gpu_bytes; }
+};
+
+// Load options from the performance settings: use_gpu, and on macOS also use_metal
+// (Metal is the only GPU backend there)
+ModelLoadOptions model_load_options(const Settings& settings);
+
+// Print a breakdown of `stats`, one line per component
+void print_memory_stats(const MemoryStats& stats);
+
+// False (with a message) if a loaded model exceeds budget_mb; a budget of 0 is unlimited
+bool check_memory_budget(const MemoryStats& stats, int budget_mb);
 
 // Whisper wrapper interface
 class WhisperWrapper {
 public:
     virtual ~WhisperWrapper() = default;
     
-    virtual bool load_model(const std::string& path) = 0;
-    virtual std::string transcribe(const AudioBuffer& audio, int sample_rate, const Settings& settings) = 0;
+    virtual bool load_model(const std::string& path, const ModelLoadOptions& options) = 0;
+    bool load_model(const std::string& path) {
+        return load_model(path, ModelLoadOptions{});
+    }
+    
+    // Size the reusable decode buffers for utterances of up to max_samples at sample_rate,
+    // so steady-state transcription does not allocate. Returns the bytes now reserved.
+    virtual size_t reserve(size_t max_samples, int sample_rate) = 0;
+    
+    // Transcribe a (possibly wrapped) view straight out of the capture ring - no copy.
+    // The text lives in the wrapper's output buffer and is valid until the next call.
+    virtual const std::string& transcribe(const AudioView& audio, int sample_rate, const Settings& settings) = 0;
+    
+    // Raw segments for callers that do their own stitching (e.g. streaming mode)
+    virtual TranscriptSegments transcribe_segments(const AudioView& audio, int sample_rate, const Settings& settings) = 0;
+    
+    // Same, for audio the caller has already run the VAD over: with vad_trim_silence the
+    // decode trims to `speech` instead of detecting again. An empty list means detect here.
+    virtual TranscriptSegments transcribe_segments(const AudioView& audio, int sample_rate, const Settings& settings,
+                                                   const SpeechRegions& speech) {
+        (void)speech;
+        return transcribe_segments(audio, sample_rate, settings);
+    }
+    
+    // Contiguous audio (AudioBuffer, std::span, ...)
+    const std::string& transcribe(std::span<const AudioSample> audio, int sample_rate, const Settings& settings) {
+        return transcribe(AudioView{audio, {}, 0}, sample_rate, settings);
+    }
+    
+    TranscriptSegments transcribe_segments(std::span<const AudioSample> audio, int sample_rate, const Settings& settings) {
+        return transcribe_segments(AudioView{audio, {}, 0}, sample_rate, settings);
+    }
     virtual bool is_loaded() const = 0;
     
+    // Context carry-over for dictation sessions: the last max_tokens text tokens of what
+    // has been committed are the decoder prompt of the next call (0 disables, the default).
+    // transcribe() commits its own result; callers of transcribe_segments() that stitch
+    // commit the text they keep. Loading another model drops the context.
+    virtual void set_context_tokens(int max_tokens) = 0;
+    virtual void commit_context(const std::string& text) = 0;
+    virtual void reset_context() = 0;
+    
+    // Deliver segments while a transcription is still running (empty: off). Timestamps are
+    // final; the complete result is still returned by transcribe() / transcribe_segments().
+    virtual void set_segment_callback(SegmentCallback callback) = 0;
+    
+    // Timing breakdown of the most recent transcribe call
+    virtual DecodeTimings last_timings() const = 0;
+    
     // Memory management
     virtual void unload_model() = 0;
-    virtual size_t get_memory_usage() const = 0;
+    virtual MemoryStats memory_stats() const = 0;
+    size_t get_memory_usage() const {
+        return memory_stats().total_bytes();
+    }
 };
 
+// Render segments in one of the supported output formats (text, json, srt, vtt, csv).
+// Built on the writers in segment_sink.hpp, which can also render segment by segment.
+std::string format_transcript(const TranscriptSegments& segments, const std::string& format);
+
+// Same, rendered into `out` (cleared first) so a reused string keeps its capacity
+void format_transcript(std::span<const TranscriptSegment> segments, const std::string& format, std::string& out);
+
+// Loaded model weights, shareable between wrappers (see WhisperPool)
+struct WhisperModel;
+
+// Load model weights without a decode state; returns nullptr on failure
+std::shared_ptr<WhisperModel> load_whisper_model(const std::string& path, const ModelLoadOptions& options = {});
+
 // Factory function for creating Whisper wrapper
 std::unique_ptr<WhisperWrapper> create_whisper_wrapper();
 
+// Wrapper with its own decode state on an already loaded model (nullptr on failure)
+std::unique_ptr<WhisperWrapper> create_whisper_wrapper(std::shared_ptr<WhisperModel> model);
+
 } // namespace SuperWhisper